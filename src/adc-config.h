@@ -0,0 +1,36 @@
+/**
+ * \file adc-config.h
+ * \brief Lists the sampled analog channels
+ * \details Each channel is given by the input of \ref adc.h and the name of
+ * the reply field in \ref FRAME_CONFIG_REPLY which receives its result. The
+ * channels are sampled in the given order. The inputs PC4 and PC5 must not be
+ * used if the TWI bus is enabled.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef ADC_CONFIG_H_
+#define ADC_CONFIG_H_
+
+#include "adc.h"
+
+/** \brief The list of every sampled channel */
+#define ADC_CONFIG(CHANNEL) \
+	CHANNEL(ADC_MUX_PC3, lightLevel) \
+	CHANNEL(ADC_MUX_BANDGAP, supplyVoltage)
+
+#endif /* ADC_CONFIG_H_ */
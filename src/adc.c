@@ -0,0 +1,149 @@
+/**
+ * \file adc.c
+ * \brief Implements the analog sampling module
+ * \details In free running mode, the next conversion starts as soon as the
+ * previous one completed. Hence, a new input selection applies to the
+ * conversion after the running one. The interrupt routine selects the next
+ * channel one sample in advance and discards the first sample of every
+ * channel until the input settled. The module occupies the ADC including its
+ * interrupt. It is assumed that the hardware resources are not shared.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "adc.h"
+#include "adc-config.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include <stdint.h>
+
+#if ADC_OVERSAMPLING_BITS > 3
+#error "The sum of the samples exceeds 16 bit"
+#endif
+
+/** \brief The number of samples per result */
+#define ADC_SAMPLES (1 << (2 * ADC_OVERSAMPLING_BITS))
+
+/**
+ * \brief The number of discarded samples after switching the channel
+ * \details The discarded sample grants the input, in particular the bandgap
+ * reference, some time to settle.
+ */
+#define ADC_DISCARD (1)
+
+/**
+ * \brief The prescaler bits of the ADC clock
+ * \details The prescaler of 128 results in an ADC clock of about 65 kHz, i.e.
+ * about 5000 samples per second.
+ */
+#define ADC_PRESCALER (_BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0))
+
+/** \brief The reference selection which is added to every input selection */
+#define ADC_REFERENCE (_BV(REFS0))
+
+/** \brief The nominal bandgap voltage in millivolts */
+#define ADC_BANDGAP_MV (1300UL)
+
+/** \brief Expands to the input selection of a channel */
+#define ADC_MUX_ENTRY(mux, field) (mux),
+
+/** \brief The input selection of every channel */
+static const uint8_t adc_mux[] PROGMEM = { ADC_CONFIG(ADC_MUX_ENTRY) };
+
+/** \brief The number of channels */
+#define ADC_CHANNEL_COUNT (sizeof(adc_mux) / sizeof(adc_mux[0]))
+
+/** \brief The latest result of every channel */
+static volatile uint16_t adc_result[ADC_CHANNEL_COUNT];
+/** \brief The currently sampled channel */
+static uint8_t adc_channel;
+/** \brief The number of completed conversions of the current channel */
+static uint8_t adc_count;
+/** \brief The sum of the samples of the current channel */
+static uint16_t adc_sum;
+
+void adc_init(void) {
+	uint8_t i;
+
+	for (i = 0; i < ADC_CHANNEL_COUNT; i++) {
+		adc_result[i] = 0;
+	}
+	adc_channel = 0;
+	adc_count = 0;
+	adc_sum = 0;
+
+	// Disable the pull-up of the analog input
+	DDRC &= ~_BV(PC3);
+	PORTC &= ~_BV(PC3);
+
+	ADMUX = ADC_REFERENCE | pgm_read_byte(&adc_mux[0]);
+	ADCSRA = _BV(ADEN) | _BV(ADSC) | _BV(ADFR) | _BV(ADIE) | ADC_PRESCALER;
+}
+
+int16_t adc_getValue(uint8_t index) {
+	uint16_t value;
+
+	if (index >= ADC_CHANNEL_COUNT) {
+		return 0;
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		value = adc_result[index];
+	}
+
+	if (pgm_read_byte(&adc_mux[index]) == ADC_MUX_BANDGAP && value != 0) {
+		// The bandgap voltage is given in units of the supply voltage
+		value = (ADC_BANDGAP_MV << ADC_RESOLUTION_BITS) / value;
+	}
+	return (int16_t) value;
+}
+
+/**
+ * \brief Collects a single sample
+ * \details The result of a channel is stored as soon as every sample was
+ * collected.
+ */
+ISR(ADC_vect, ISR_BLOCK) {
+	uint8_t next;
+
+	if (adc_count >= ADC_DISCARD) {
+		adc_sum += ADC;
+	}
+	adc_count++;
+
+	if (adc_count == ADC_DISCARD + ADC_SAMPLES - 1) {
+		// The last sample is running, select the next channel
+		next = adc_channel + 1;
+		if (next >= ADC_CHANNEL_COUNT) {
+			next = 0;
+		}
+		ADMUX = ADC_REFERENCE | pgm_read_byte(&adc_mux[next]);
+
+	} else if (adc_count == ADC_DISCARD + ADC_SAMPLES) {
+		adc_result[adc_channel] = adc_sum >> ADC_OVERSAMPLING_BITS;
+		adc_sum = 0;
+		// The running conversion already belongs to the next channel
+		adc_count = 0;
+		adc_channel++;
+		if (adc_channel >= ADC_CHANNEL_COUNT) {
+			adc_channel = 0;
+		}
+	}
+}
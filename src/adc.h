@@ -0,0 +1,83 @@
+/**
+ * \file adc.h
+ * \brief Specifies the interface of the analog sampling module
+ * \details The module samples every channel of \ref adc-config.h in turn. The
+ * ADC runs in free running mode and each completed conversion is collected by
+ * the ADC interrupt routine. The samples of a channel are oversampled and
+ * decimated which adds \ref ADC_OVERSAMPLING_BITS bits of resolution, provided
+ * that the signal carries some noise. The interrupt routine neither wakes the
+ * main loop nor posts any work item. Instead, the latest result of each
+ * channel is fetched by \ref adc_getValue whenever it is needed.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef ADC_H_
+#define ADC_H_
+
+#include <stdint.h>
+
+/**
+ * \brief The number of additional bits gained by oversampling
+ * \details Each result is the sum of 4^n samples which is shifted right by n
+ * bits.
+ */
+#ifndef ADC_OVERSAMPLING_BITS
+#define ADC_OVERSAMPLING_BITS (2)
+#endif
+
+/** \brief The resolution of each result in bits */
+#define ADC_RESOLUTION_BITS (10 + ADC_OVERSAMPLING_BITS)
+
+/** \brief Selects the input PC3 */
+#define ADC_MUX_PC3 (0x03)
+/** \brief Selects the input PC4 which is occupied by the TWI bus */
+#define ADC_MUX_PC4 (0x04)
+/** \brief Selects the input PC5 which is occupied by the TWI bus */
+#define ADC_MUX_PC5 (0x05)
+/** \brief Selects the input ADC6 which is only available in TQFP packages */
+#define ADC_MUX_ADC6 (0x06)
+/** \brief Selects the input ADC7 which is only available in TQFP packages */
+#define ADC_MUX_ADC7 (0x07)
+/**
+ * \brief Selects the internal bandgap reference
+ * \details The result of the channel is the supply voltage in millivolts
+ * which is derived from the measured bandgap voltage.
+ */
+#define ADC_MUX_BANDGAP (0x0E)
+
+/**
+ * \brief Initializes the module and starts sampling
+ * \details The function has to be called before any other function of the
+ * module is used. It is assumed that global interrupts are disabled. The
+ * supply voltage AVCC is used as reference.
+ */
+void adc_init(void);
+
+/**
+ * \brief Returns the latest result of the given channel
+ * \details The result of an input channel is given in
+ * 2^-\ref ADC_RESOLUTION_BITS units of the supply voltage. The bandgap channel
+ * returns the supply voltage in millivolts. Zero is returned until the first
+ * result is available.
+ * \param index The index of the channel in \ref ADC_CONFIG
+ * \return The result of the channel
+ */
+int16_t adc_getValue(uint8_t index);
+
+#endif /* ADC_H_ */
@@ -2,7 +2,16 @@
  * \file am2303.c
  * \brief Implements the module which drives the DHT22/AM2303 sensor
  * \details The decoding logic is implemented in an interrupt driven way. It
- * doesn't require a periodic update function. The module occupies the following
+ * doesn't require a periodic update function. Both channels are decoded
+ * concurrently. Timer/Counter 0 runs freely and each edge is measured by the
+ * difference to the previous edge's time stamp of the same channel. The
+ * timer's overflow interrupt is only armed during a read cycle. It times the
+ * start sequence and detects missing edges. The edge interrupts only store the
+ * duration of each high phase. The message is decoded afterwards by a deferred
+ * work item outside of any interrupt context. Hence, the interrupts are
+ * short and don't delay the UART. The bit threshold is derived from the
+ * measured high start pulse of each message. It compensates deviations of the
+ * sensor's timing and of the CPU clock. The module occupies the following
  * hardware resources:
  * <ul>
  *   <li>PD2 (INT0): Channel 0, data line </li>
@@ -30,236 +39,422 @@
  */
 
 #include "am2303.h"
+#include "deferred.h"
 #include "debug.h"
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <util/atomic.h>
 #include <stdint.h>
 
 /** \brief IDLE or issue start sequence state */
 #define STATE_IDLE (0)
-/** \brief Waits until the sensor issues its start sequence */
-#define STATE_START (1)
-/** \brief Intermediate state which waits for the first bit's falling edge */
-#define STATE_BEGIN_TRANSMISSION (2)
-/** \brief waits until the next bit can be read */
-#define STATE_READ_WAIT (3)
-/** \brief Measures the time in order to determine the bit value */
-#define STATE_READ_MEASURE (4)
-/** \brief Waits for the last rising edge and processes the message */
-#define STATE_AWAIT_LAST_EDGE (5)
+/** \brief Records the edges of the sensor's response */
+#define STATE_RECEIVE (1)
+/** \brief Every edge was recorded and the message needs to be decoded */
+#define STATE_RECEIVED (2)
+/** \brief The sensor stopped responding and the error needs to be reported */
+#define STATE_NO_SIGNAL (3)
 
 /** \brief The number of bytes per message including the checksum byte */
 #define AM2303_MESSAGE_SIZE (5)
 
 /**
- * \brief encapsulates the module's data
- * \details After am2303_startReading() was invoked the structure's members are
- * only accessed by interrupt routines. Any access while the module is in an
- * active state may corrupt the data structure.
+ * \brief The number of edges of the sensor's response
+ * \details The first edge is the rising edge at the end of the low start pulse.
+ * The falling edge at the end of the high start pulse follows. Each bit adds a
+ * rising and a falling edge and the response ends with a final rising edge.
  */
-volatile struct {
-	uint8_t state :3; //< \brief The module's current state
-	uint8_t byteNr :3; //< \brief The currently received byte
-	uint8_t bitNr :3; //< \brief The currently received bit number
-	uint8_t channel :1; //< \brief The requested channel number
-} am2303_data;
+#define AM2303_EDGE_COUNT (2 + 2 * 8 * AM2303_MESSAGE_SIZE + 1)
 
-/** \brief The assigned callback function */
-am2303_readDone_t am2303_callback;
+/**
+ * \brief The number of recorded high phase durations
+ * \details The first duration belongs to the high start pulse. Each following
+ * duration encodes a single bit, most significant bit first.
+ */
+#define AM2303_DELTA_COUNT (1 + 8 * AM2303_MESSAGE_SIZE)
+
+/** \brief The prescaler of the free-running timer */
+#define AM2303_PRESCALER (8UL)
+
+/**
+ * \brief returns the number of timer ticks of the given time
+ * \param us The time in microseconds
+ */
+#define AM2303_US_TO_TICKS(us) \
+	((F_CPU/AM2303_PRESCALER*(us) + 500000UL)/(1000000UL))
+
+/** \brief The nominal duration of the high start pulse in microseconds */
+#define AM2303_PREAMBLE_US (80UL)
+
+/**
+ * \brief The threshold between a zero and a one bit in microseconds
+ * \details A zero bit is signaled by a high phase of 26us to 28us. A one bit is
+ * signaled by a high phase of 70us. The threshold lies in between.
+ */
+#define AM2303_THRESHOLD_US (48UL)
+
+/** \brief The minimal duration of a plausible high start pulse */
+#define AM2303_PREAMBLE_MIN_US (50UL)
+/** \brief The maximal duration of a plausible high start pulse */
+#define AM2303_PREAMBLE_MAX_US (120UL)
+
+#if AM2303_US_TO_TICKS(AM2303_PREAMBLE_MAX_US) > 255
+#error "The CPU frequency is too high for the timer prescaler"
+#endif
+#if AM2303_US_TO_TICKS(AM2303_THRESHOLD_US) < 16
+#error "The CPU frequency is too low to decode the sensor's bits reliably"
+#endif
+
+/**
+ * \brief The duration of the start signal in microseconds
+ * \details The sensor requires the data line to be pulled low for at least
+ * 800us. Two milliseconds leave enough margin without prolonging the read
+ * cycle unnecessarily.
+ */
+#define AM2303_START_US (2000UL)
+
+/**
+ * \brief The number of timer overflows without any edge which indicate a
+ * missing signal
+ * \details A single overflow period of the timer exceeds every regular edge
+ * interval. Since the first overflow may occur right after the last edge, two
+ * overflows are required.
+ */
+#define AM2303_TIMEOUT_OVERFLOWS (2)
+
+/** \brief The external interrupt enable bit of the given channel */
+#define AM2303_INT_BIT(channel) ((channel) ? _BV(INT1) : _BV(INT0))
+/** \brief The interrupt sense control bits of the given channel */
+#define AM2303_ISC_BITS(channel) \
+	((channel) ? _BV(ISC11) | _BV(ISC10) : _BV(ISC01) | _BV(ISC00))
+/** \brief The interrupt sense control bit which selects any logical change */
+#define AM2303_ISC_ANY_BIT(channel) ((channel) ? _BV(ISC10) : _BV(ISC00))
+/** \brief The data line pin of the given channel */
+#define AM2303_PIN_BIT(channel) ((channel) ? _BV(PD3) : _BV(PD2))
 
-/** \brief A buffer which contains the received message */
-uint8_t am2303_messageBuffer[AM2303_MESSAGE_SIZE];
+/**
+ * \brief returns the number of timer overflows which cover the given time
+ * \param us The time in microseconds
+ */
+#define AM2303_OVERFLOW_VAL(us) \
+	((F_CPU/AM2303_PRESCALER*(us)/256 + 1000000UL - 1)/(1000000UL))
+
+/**
+ * \brief encapsulates the data of a single channel
+ * \details After am2303_startReading() was invoked the structure's members are
+ * only accessed by interrupt routines until the state changes to
+ * STATE_RECEIVED or STATE_NO_SIGNAL. Any access while the channel is in an
+ * active state may corrupt the data structure. Each member occupies its own
+ * byte in order to avoid read-modify-write cycles on shared bit fields.
+ */
+typedef struct {
+	uint8_t state; //< \brief The channel's current state
+	uint8_t edgeNr; //< \brief The number of recorded edges
+	/** \brief The number of timer overflows since the last edge */
+	uint8_t idleOverflows;
+	/** \brief The timer value at the last edge */
+	uint8_t lastEdge;
+	/** \brief The duration of each high phase in timer ticks */
+	uint8_t delta[AM2303_DELTA_COUNT];
+} am2303_channel_t;
+
+/** \brief The data of each channel */
+volatile am2303_channel_t am2303_channel[AM2303_CHANNEL_COUNT];
+
+/** \brief The channels which are selected by the current request */
+volatile uint8_t am2303_requested;
 
 /**
- * \brief returns the number of timer ticks for the given configuration
- * \param prescaler The currently used prescaler
- * \param us2top the time consumed by all ticks
+ * \brief The number of timer overflows until the data lines are released
+ * \details A non-zero value indicates that the start signal is issued.
  */
-#define AM2303_TICK_VAL(prescaler,us2top) \
-	((F_CPU/(prescaler)*(us2top) + 1000000UL - 1)/(1000000UL))
+volatile uint8_t am2303_startOverflows;
+
+/** \brief The assigned callback function */
+sensor_readDone_t am2303_callback;
+
+const sensor_driver_t am2303_driver = { am2303_startReading, 2 };
+
+/** \brief The read statistics of each channel */
+am2303_statistics_t am2303_statistics[AM2303_CHANNEL_COUNT];
 
 /* Function prototypes */
-inline void am2303_processMessage(void);
+static void am2303_releaseLines(void);
+static inline void am2303_processEdge(uint8_t channel)
+		__attribute__((always_inline));
+static void am2303_complete(uint8_t channel);
+static void am2303_processMessage(uint8_t channel);
+static uint8_t am2303_threshold(uint8_t preamble);
 
 void am2303_init(void) {
-	// Initialize output pins
-	DDRD &= ~(_BV(PD2) | _BV(PD2));
-	PORTD |= _BV(PD2) | _BV(PD2);
+	uint8_t channel;
 
-	// Disarm timer
+	// Initialize input pins
+	DDRD &= ~(_BV(PD2) | _BV(PD3));
+	PORTD |= _BV(PD2) | _BV(PD3);
+
+	// Start the free-running timer but disarm its interrupt
+	TCCR0 = _BV(CS01); // Prescaler 8
 	TIMSK &= ~(_BV(TOIE0));
 
 	// Disarm external interrupts
 	GICR &= ~(_BV(INT0) | _BV(INT1));
 
 	// Initialize state
-	am2303_data.state = STATE_IDLE;
+	for (channel = 0; channel < AM2303_CHANNEL_COUNT; channel++) {
+		am2303_channel[channel].state = STATE_IDLE;
+		am2303_statistics[channel].reads = 0;
+		am2303_statistics[channel].chksumErrors = 0;
+		am2303_statistics[channel].noSignalErrors = 0;
+	}
+	am2303_requested = 0;
+	am2303_startOverflows = 0;
+}
+
+status_t am2303_getStatistics(uint8_t channel,
+		am2303_statistics_t *statistics) {
+	if (channel >= AM2303_CHANNEL_COUNT) {
+		return err_invalidChannel;
+	}
+	*statistics = am2303_statistics[channel];
+	return success;
 }
 
-void am2303_startReading(uint8_t channel, am2303_readDone_t callback) {
-
-	am2303_callback = callback;
-	am2303_data.channel = channel & 0x01;
-	am2303_data.state = STATE_IDLE;
-	am2303_data.byteNr = 0;
-	am2303_data.bitNr = 0;
-
-	switch (channel) {
-	case 0:
-		DDRD |= _BV(PD2);
-		PORTD &= ~_BV(PD2);
-		break;
-	case 1:
-		DDRD |= _BV(PD3);
-		PORTD &= ~_BV(PD3);
-		break;
-	default:
-		callback(err_invalidChannel, 0, 0, channel);
+status_t am2303_startReading(uint8_t channels, sensor_readDone_t callback) {
+	uint8_t channel;
+
+	if (channels == 0 || (channels & ~((1 << AM2303_CHANNEL_COUNT) - 1))) {
+		return err_invalidChannel;
+	}
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		am2303_callback = callback;
+		am2303_requested = channels;
+
+		for (channel = 0; channel < AM2303_CHANNEL_COUNT; channel++) {
+			am2303_channel[channel].state = STATE_IDLE;
+			am2303_channel[channel].edgeNr = 0;
+
+			if (channels & (1 << channel)) {
+				// Pull the data line low
+				DDRD |= AM2303_PIN_BIT(channel);
+				PORTD &= ~AM2303_PIN_BIT(channel);
+			}
+		}
+
+		// The first overflow may follow immediately
+		am2303_startOverflows = AM2303_OVERFLOW_VAL(AM2303_START_US) + 1;
+		TIFR |= _BV(TOV0); // Clear flag
+		TIMSK |= _BV(TOIE0);
 	}
 
-	// Setup timer to fire in ~18ms
-	TCCR0 = _BV(CS02) | _BV(CS00); // Prescaler 1024
-	TIFR |= _BV(TOV0); // Clear flag
-	TCNT0 = 256 - AM2303_TICK_VAL(1024UL,18000UL);
+	return success;
+}
+
+/**
+ * \brief Releases the data lines of the requested channels
+ * \details The function finishes the start sequence and arms the external
+ * interrupts in order to await the sensors' response. It is assumed that
+ * interrupts are disabled.
+ */
+static void am2303_releaseLines(void) {
+	uint8_t channel;
+	uint8_t now = TCNT0;
+
+	for (channel = 0; channel < AM2303_CHANNEL_COUNT; channel++) {
+		if (am2303_requested & (1 << channel)) {
+			am2303_channel[channel].state = STATE_RECEIVE;
+			am2303_channel[channel].idleOverflows = 0;
+			am2303_channel[channel].lastEdge = now;
+
+			// Release data line
+			DDRD &= ~AM2303_PIN_BIT(channel);
+			PORTD |= AM2303_PIN_BIT(channel);
+
+			// Set interrupt to next rising edge
+			MCUCR |= AM2303_ISC_BITS(channel);
+		}
+	}
 
-	TIMSK |= _BV(TOIE0);
+	GIFR |= _BV(INTF1) | _BV(INTF0);
+	GICR |= (am2303_requested & 0x01 ? AM2303_INT_BIT(0) : 0)
+			| (am2303_requested & 0x02 ? AM2303_INT_BIT(1) : 0);
 }
 
 /**
  * \brief Performs a timed action
- * \details If the state of the module is IDLE, the data line will be released
- * and further actions will be prepared. Otherwise an error will be reported by
- * calling the callback function.
+ * \details While the start signal is issued, the ISR counts the timer
+ * overflows and releases the data lines afterwards. Otherwise, it detects
+ * missing edges of every receiving channel and reports the failed channel via
+ * the deferred work queue.
+ * The interrupt is disarmed as soon as no channel is receiving.
  */
 ISR(TIMER0_OVF_vect, ISR_BLOCK) {
+	uint8_t channel;
+	uint8_t active = 0;
 
-	if (am2303_data.state == STATE_IDLE) {
-
-		am2303_data.state = STATE_START;
-
-		// Release data line
-		DDRD &= ~(_BV(PD2) | _BV(PD3));
-		PORTD |= _BV(PD2) | _BV(PD3);
-
-		// Set interrupt to next rising edge
-		MCUCR |= _BV(ISC11) | _BV(ISC10) | _BV(ISC01) | _BV(ISC00);
-		GIFR |= _BV(INTF1) | _BV(INTF0);
-		switch (am2303_data.channel) {
-		case 0:
-			GICR |= _BV(INT0);
-			break;
-		case 1:
-			GICR |= _BV(INT1);
-			break;
+	if (am2303_startOverflows > 0) {
+		am2303_startOverflows--;
+		if (am2303_startOverflows == 0) {
+			am2303_releaseLines();
 		}
+		return;
+	}
 
-		// Set timeout >120us
-		TCCR0 = _BV(CS01); // Prescaler 8
-		TCNT0 = 136;
-		TIFR |= _BV(TOV0); // Clear interrupt flag
+	for (channel = 0; channel < AM2303_CHANNEL_COUNT; channel++) {
+		if (am2303_channel[channel].state != STATE_RECEIVE) {
+			// Nothing to do
+		} else if (am2303_channel[channel].idleOverflows
+				< AM2303_TIMEOUT_OVERFLOWS - 1) {
+			am2303_channel[channel].idleOverflows++;
+			active = 1;
+		} else {
+			// Stop the channel and report the error later on
+			GICR &= ~AM2303_INT_BIT(channel);
+			am2303_channel[channel].state = STATE_NO_SIGNAL;
+			// The queue has room for each channel, see AM2303_DEFERRED_ITEMS
+			(void) deferred_post(am2303_complete, channel);
+		}
+	}
 
-	} else {
-		// Stop the timer and issue an error
+	if (!active && am2303_startOverflows == 0) {
 		TIMSK &= ~(_BV(TOIE0));
-		GICR &= ~(_BV(INT0) | _BV(INT1));
-		am2303_callback(err_noSignal, am2303_data.state, 0, am2303_data.channel);
-		am2303_data.state = STATE_IDLE;
 	}
 }
 
 /**
- * \brief Decodes the message after the initial start sequence was received
- * \details The ISR may be used for INT0 and INT1. It runs the state machine and
- * follows the received bit stream. It uses timer 0 in order to measure the
- * interval between two edges. During normal operation, timer interrupts will
- * not be executed.
+ * \brief Records a single edge of the given channel
+ * \details The function stores the duration of each high phase which ends on
+ * a falling edge. The interval between two edges is measured by the
+ * free-running timer. Hence, the channels don't interfere with each other. The
+ * first edge is a rising edge. Afterwards, the interrupt is triggered on any
+ * state change. It is assumed that interrupts are disabled.
+ * \param channel The channel whose data line changed
  */
-ISR(INT0_vect, ISR_BLOCK) {
-	uint8_t cnt = TCNT0;
-	TCNT0 = 0;
+static inline void am2303_processEdge(uint8_t channel) {
+	volatile am2303_channel_t *chn = &am2303_channel[channel];
+	uint8_t now = TCNT0;
+	uint8_t edgeNr = chn->edgeNr;
+
+	if (edgeNr & 0x01) {
+		// Falling edge, record the duration of the high phase
+		chn->delta[edgeNr >> 1] = now - chn->lastEdge;
+	} else if (edgeNr == 0) {
+		// Trigger an interrupt on any state change
+		MCUCR &= ~AM2303_ISC_BITS(channel);
+		MCUCR |= AM2303_ISC_ANY_BIT(channel);
+	}
 
-	if (am2303_data.state == STATE_START) {
-		// rising edge of the start bit
-		// -> wait until the next falling edge (first bit)
-		am2303_data.state = STATE_BEGIN_TRANSMISSION;
+	chn->lastEdge = now;
+	chn->idleOverflows = 0;
 
-		// Trigger an interrupt on any state change
-		switch (am2303_data.channel) {
-		case 0:
-			MCUCR |= _BV(ISC00);
-			MCUCR &= ~_BV(ISC01);
-			break;
-		case 1:
-			MCUCR |= _BV(ISC10);
-			MCUCR &= ~_BV(ISC11);
-			break;
-		}
+	edgeNr++;
+	if (edgeNr == AM2303_EDGE_COUNT) {
+		// disarm the external interrupt, the timer disarms itself
+		GICR &= ~AM2303_INT_BIT(channel);
+		chn->state = STATE_RECEIVED;
+		// The queue has room for each channel, see AM2303_DEFERRED_ITEMS
+		(void) deferred_post(am2303_complete, channel);
+	}
+	chn->edgeNr = edgeNr;
+}
 
-	} else if (am2303_data.state == STATE_BEGIN_TRANSMISSION) {
-		am2303_data.state = STATE_READ_WAIT;
-	} else if (am2303_data.state == STATE_READ_WAIT) {
-		am2303_data.state = STATE_READ_MEASURE;
-	} else if (am2303_data.state == STATE_READ_MEASURE) {
-		// Process bit
-		uint8_t bit = (cnt > 49 ? 1 : 0);
-		am2303_messageBuffer[am2303_data.byteNr] <<= 1;
-		am2303_messageBuffer[am2303_data.byteNr] |= bit;
-
-		am2303_data.state = STATE_READ_WAIT;
-
-		if (am2303_data.bitNr == 7) {
-			// Byte is fully populated
-			am2303_data.bitNr = 0;
-			if (am2303_data.byteNr == AM2303_MESSAGE_SIZE - 1) {
-				// Message is fully received
-				am2303_data.byteNr = 0;
-				am2303_data.state = STATE_AWAIT_LAST_EDGE;
-
-			} else {
-				am2303_data.byteNr++;
-			}
-		} else {
-			am2303_data.bitNr++;
-		}
-	} else if (am2303_data.state == STATE_AWAIT_LAST_EDGE) {
-		am2303_data.state = STATE_IDLE;
+/** \brief Records the edges of channel 0 */
+ISR(INT0_vect, ISR_BLOCK) {
+	am2303_processEdge(0);
+}
 
-		// disarm the timer and external interrupts
-		TIMSK &= ~(_BV(TOIE0));
-		GICR &= ~(_BV(INT0) | _BV(INT1));
+/** \brief Records the edges of channel 1 */
+ISR(INT1_vect, ISR_BLOCK) {
+	am2303_processEdge(1);
+}
 
-		// Process message
-		am2303_processMessage();
+/**
+ * \brief Finishes the read cycle of a single channel
+ * \details The function is executed as deferred work item after the channel
+ * stopped receiving. It decodes the message or reports the missing signal.
+ * \param channel The channel which finished its read cycle
+ */
+static void am2303_complete(uint8_t channel) {
+	uint8_t state = am2303_channel[channel].state;
+	int16_t values[2] = { 0, 0 };
+
+	if (state == STATE_RECEIVED) {
+		am2303_channel[channel].state = STATE_IDLE;
+		am2303_processMessage(channel);
+
+	} else if (state == STATE_NO_SIGNAL) {
+		am2303_channel[channel].state = STATE_IDLE;
+		am2303_statistics[channel].reads++;
+		am2303_statistics[channel].noSignalErrors++;
+		am2303_callback(&am2303_driver, channel, err_noSignal, values);
 	}
 }
 
-/*** \brief Redirects INT1 to INT0 which handles both interrupts */
-ISR(INT1_vect, ISR_ALIASOF(INT0_vect));
+/**
+ * \brief Returns the bit threshold which corresponds to the given start pulse
+ * \details The threshold scales with the measured duration of the high start
+ * pulse. If the duration is implausible, the nominal threshold is returned.
+ * \param preamble The duration of the high start pulse in timer ticks
+ * \return The minimal duration of a one bit in timer ticks
+ */
+static uint8_t am2303_threshold(uint8_t preamble) {
+	if (preamble < AM2303_US_TO_TICKS(AM2303_PREAMBLE_MIN_US)
+			|| preamble > AM2303_US_TO_TICKS(AM2303_PREAMBLE_MAX_US)) {
+		return AM2303_US_TO_TICKS(AM2303_THRESHOLD_US);
+	}
+	return ((uint16_t) preamble * AM2303_THRESHOLD_US
+			+ AM2303_PREAMBLE_US / 2) / AM2303_PREAMBLE_US;
+}
 
 /**
- * \brief Processes the previously received message
- * \details The function assumes that interrupts are turned off. It may
- * temporarily enable interrupts during non critical sections. After the message
- * is decoded, the callback function is invoked. The function requires a fully
- * populated message buffer and may be called in an interrupt context
+ * \brief Decodes the previously received message
+ * \details The function classifies each recorded high phase as a bit. The
+ * threshold is derived from the high start pulse. After the message is
+ * decoded, the statistics are updated and the callback function is invoked.
+ * The temperature is converted from its sign and magnitude representation to
+ * the two's complement.
+ * The function requires a fully populated delta buffer. The channel must not
+ * be receiving.
+ * \param channel The channel which received the message
  */
-inline void am2303_processMessage(void) {
+static void am2303_processMessage(uint8_t channel) {
+	volatile uint8_t *delta = &am2303_channel[channel].delta[1];
+	uint8_t message[AM2303_MESSAGE_SIZE];
+	uint8_t byteNr, bitNr, threshold;
 	uint8_t chksum;
-	uint16_t temperature, humidity;
-
-	sei();
+	uint16_t temperature;
+	int16_t values[2];
+	status_t status;
+
+	threshold = am2303_threshold(am2303_channel[channel].delta[0]);
+
+	for (byteNr = 0; byteNr < AM2303_MESSAGE_SIZE; byteNr++) {
+		message[byteNr] = 0;
+		for (bitNr = 0; bitNr < 8; bitNr++) {
+			message[byteNr] <<= 1;
+			message[byteNr] |= (*delta >= threshold ? 1 : 0);
+			delta++;
+		}
+	}
 
-	chksum = am2303_messageBuffer[0];
-	chksum += am2303_messageBuffer[1];
-	chksum += am2303_messageBuffer[2];
-	chksum += am2303_messageBuffer[3];
+	chksum = message[0];
+	chksum += message[1];
+	chksum += message[2];
+	chksum += message[3];
 
-	humidity = am2303_messageBuffer[1] | (am2303_messageBuffer[0] << 8);
-	temperature = am2303_messageBuffer[3] | (am2303_messageBuffer[2] << 8);
+	values[1] = message[1] | (message[0] << 8);
+	temperature = message[3] | ((message[2] & 0x7F) << 8);
+	values[0] = (message[2] & 0x80 ? -(int16_t) temperature : temperature);
 
-	am2303_callback((chksum == am2303_messageBuffer[4] ? success : err_chksum),
-			temperature, humidity, am2303_data.channel);
+	status = (chksum == message[4] ? success : err_chksum);
+	am2303_statistics[channel].reads++;
+	if (status != success) {
+		am2303_statistics[channel].chksumErrors++;
+		DEBUG_PRINT(0x06 + channel, threshold);
+	}
 
-	cli();
+	am2303_callback(&am2303_driver, channel, status, values);
 }
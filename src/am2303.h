@@ -2,9 +2,13 @@
  * \file am2303.h
  * \brief Reads the temperature and humidity value of a DHT22/am3203 sensor
  * \details The module implements an interrupt driven decoding function. It is
- * capable of decoding a single sensor at once. Another sensor may be queried
- * after a read cycle. A callback function is called on completing the read
- * cycle or on detecting an error.
+ * capable of decoding both sensor channels concurrently. Each channel keeps its
+ * own state and measures its edges against a common free-running timer. The
+ * interrupt routines only record the interval between the edges. The bits are
+ * decoded by a work item which is posted to the queue of \ref deferred.h. A
+ * callback function is called for each channel on completing its read cycle or
+ * on detecting an error. The module implements the interface of
+ * \ref sensor.h.
  * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
  *
  * Copyright (C) 2016 Michael Spiegel
@@ -29,46 +33,73 @@
 #include <stdint.h>
 
 #include "error.h"
+#include "sensor.h"
+
+/** \brief The number of supported sensor channels */
+#define AM2303_CHANNEL_COUNT (2)
 
 /**
- * \brief Defines a callback function type which indicates a completed read
- * cycle
- * \details The function may be called in an interrupt context. If and only if
- * the given status is <code>success</code>, the temperature and humidity
- * variables will contain valid values. The channel parameter indicates the
- * requested channel number.
- * \param status The status of the operation
- * \param temperature The received temperature value. If the status is not
- * successful, it may contain arbitrary content.
- * \param humidity The received humidity value. If the status is not successful,
- * it may contain arbitrary content.
- * \param channel The requested channel
+ * \brief The maximal number of deferred work items which the module posts
+ * at the same time
+ * \details Each channel posts a single item per read cycle.
  */
+#define AM2303_DEFERRED_ITEMS (AM2303_CHANNEL_COUNT)
 
-typedef void (* am2303_readDone_t)(status_t status, uint16_t temperature,
-		uint16_t humidity, uint8_t channel);
+/**
+ * \brief The driver descriptor of the module
+ * \details Each channel delivers the temperature in 0.1 degree Celsius
+ * followed by the relative humidity in 0.1 percent.
+ */
+extern const sensor_driver_t am2303_driver;
+
+/**
+ * \brief Holds the read statistics of a single channel
+ * \details The counters wrap around. Hence, rates have to be computed from the
+ * difference of two consecutive snapshots.
+ */
+typedef struct {
+	uint16_t reads; ///< \brief The number of completed read cycles
+	uint16_t chksumErrors; ///< \brief The number of invalid checksums
+	uint16_t noSignalErrors; ///< \brief The number of missing responses
+} am2303_statistics_t;
 
 /**
  * \brief Initializes the module
  * \details The function must be called before calling any other function. It is
- * assumed that global interrupts are not enabled.
+ * assumed that global interrupts are not enabled and that the queue of
+ * \ref deferred.h is initialized.
  */
 void am2303_init(void);
 
 /**
- * \brief Requests a sensor's values
- * \details The function will start the decoding cycle. It must be called at
- * maximum once before the given callback function is invoked. After the request
- * was processed, the callback function is invoked. It is assumed that
- * interrupts are globally enabled. The caller must assure that the function is
- * called at maximum once every two seconds. It is advised to keep a five
- * seconds interval between two consecutive measurements.
- * \param channel The channel identifier. Currently, only two channels are
- * supported.
+ * \brief Requests the values of one or more sensors
+ * \details The function will start the decoding cycle of every selected
+ * channel. The channels are read concurrently. It must be called at maximum
+ * once before the callback function was invoked for every selected channel.
+ * After the request of a channel was processed, the callback function is
+ * invoked with the corresponding channel number. It is assumed that interrupts
+ * are globally enabled. The caller must assure that the function is called at
+ * maximum once every two seconds. It is advised to keep a five seconds interval
+ * between two consecutive measurements.
+ * \param channels The channels to read. Bit n selects channel n. Currently,
+ * only two channels are supported.
  * \param callback The callback function which indicates a completed request.
- * The callback function may be invoked in an interrupt context. Additionally,
- * global interrupts may be disabled.
+ * It is invoked by deferred_tick() outside an interrupt context.
+ * \return The status of the operation. err_invalidChannel indicates that no
+ * or an unsupported channel was selected. In this case, no channel is read and
+ * the callback function won't be invoked.
+ */
+status_t am2303_startReading(uint8_t channels, sensor_readDone_t callback);
+
+/**
+ * \brief Returns the read statistics of the given channel
+ * \details The function must not be called in an interrupt context.
+ * \param channel The channel number
+ * \param statistics Receives the statistics of the channel
+ * \return The status of the operation. err_invalidChannel indicates an
+ * unsupported channel. In this case, the statistics are not altered.
  */
-void am2303_startReading(uint8_t channel, am2303_readDone_t callback);
+status_t am2303_getStatistics(uint8_t channel,
+		am2303_statistics_t *statistics);
 
 #endif /* AM2303_H_ */
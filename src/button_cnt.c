@@ -7,9 +7,10 @@
  * 	<li>PC1 (Up)</li>
  * 	<li>PC2 (Down)</li>
  * </ul>
- * A simple debouncing algorithm is used for all buttons. For each button a
- * shift register is used which counts the number of consecutive pressed
- * samples.
+ * All buttons are debounced in parallel by a vertical counter which counts
+ * the number of consecutive samples which differ from the debounced state.
+ * Holding a button results in a long press event and periodic auto-repeat
+ * events. Auto-repeated up and down buttons change the counter as well.
  *
  * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
  *
@@ -31,6 +32,8 @@
 
 #include "button_cnt.h"
 
+#include "system_timer.h"
+
 #include <avr/io.h>
 #include <stdint.h>
 
@@ -52,13 +55,68 @@
  */
 #define BUTTON_CNT_FIRST_BIT (PINC0)
 
+/** \brief The mask of every button pin of the port */
+#define BUTTON_CNT_MASK \
+	(((1 << BUTTON_CNT_CHANNELS) - 1) << BUTTON_CNT_FIRST_BIT)
+
+/**
+ * \brief The debounced state of every pin of the port
+ * \details A set bit indicates a released button since the inputs are pulled
+ * up.
+ */
+static uint8_t button_cnt_state;
+
+/**
+ * \brief The vertical counter which holds the number of consecutive samples
+ * which differ from the debounced state.
+ * \details Each bit position forms a two bit counter of the corresponding pin.
+ * The counters of every pin are updated in parallel. A new state is taken after
+ * four consecutive differing samples.
+ */
+static uint8_t button_cnt_count0, button_cnt_count1;
+
+/**
+ * \brief Converts a time interval in milliseconds to the number of fast ticks
+ * \details A fast tick lasts 256 * 128 CPU cycles. In contrast to
+ * \ref SYSTEM_TIMER_MS_TO_FAST_TICKS, the period isn't truncated to whole
+ * milliseconds. The number of ticks is rounded to the next higher integer.
+ */
+#define BUTTON_CNT_MS_TO_TICKS(time) \
+	(((time) * (unsigned long long) F_CPU + 256ULL * 128ULL * 1000ULL - 1) \
+			/ (256ULL * 128ULL * 1000ULL))
+
+/** \brief The number of fast ticks until a held button is a long press */
+#define BUTTON_CNT_LONG_TICKS (BUTTON_CNT_MS_TO_TICKS(1000))
+
+/** \brief The number of fast ticks between two auto-repeat events */
+#define BUTTON_CNT_REPEAT_TICKS (BUTTON_CNT_MS_TO_TICKS(200))
+
 /**
- * \brief The number of locked samples until the value is taken
+ * \brief The number of fast ticks until the next long press or auto-repeat
+ * event of each held button
  */
-#define BUTTON_CNT_WAIT_SAMPLES (3)
+static uint16_t button_cnt_holdTicks[BUTTON_CNT_CHANNELS];
 
-/** \brief The sampled state for each button */
-static uint8_t button_cnt_states[BUTTON_CNT_CHANNELS];
+/** \brief Flags which indicate that the long press of a button was reported */
+static uint8_t button_cnt_longPressed;
+
+/** \brief The number of fast ticks since the initialization */
+static uint16_t button_cnt_time;
+
+/** \brief The ring buffer which holds the queued events */
+static button_cnt_event_t button_cnt_queue[BUTTON_CNT_QUEUE_SIZE];
+
+/** \brief The index of the oldest queued event */
+static uint8_t button_cnt_queueFirst;
+
+/** \brief The number of queued events */
+static uint8_t button_cnt_queueCount;
+
+/** \brief The number of discarded events, saturates at 255 */
+static uint8_t button_cnt_overflows;
+
+static void button_cnt_pushEvent(uint8_t type, uint8_t button);
+static uint8_t button_cnt_processHeld(uint8_t pressed, uint8_t released);
 
 /** \brief The current value of the button counter */
 static int16_t button_cnt_value;
@@ -72,27 +130,44 @@ void button_cnt_init(button_cnt_callback_t callback) {
 	for (i = 0; i < BUTTON_CNT_CHANNELS; i++) {
 		BUTTON_CNT_DDR &= ~_BV(BUTTON_CNT_FIRST_BIT + i);
 		BUTTON_CNT_PORT |= _BV(BUTTON_CNT_FIRST_BIT + i);
-		button_cnt_states[i] = 0;
 	}
+	button_cnt_state = 0xFF;
+	button_cnt_count0 = 0;
+	button_cnt_count1 = 0;
+	button_cnt_longPressed = 0;
+	button_cnt_time = 0;
+	button_cnt_queueFirst = 0;
+	button_cnt_queueCount = 0;
+	button_cnt_overflows = 0;
 	button_cnt_value = 0;
 	button_cnt_callback = callback;
 }
 
 void button_cnt_timedFastTick(void) {
-	uint8_t i;
-	uint8_t pressed = 0;
-	uint8_t maskedValue;
+	uint8_t delta, toggle;
+	uint8_t pressed, released;
 
-	for (i = 0; i < BUTTON_CNT_CHANNELS; i++) {
-		// Shift the first bit into the state
-		button_cnt_states[i] <<= 1;
-		button_cnt_states[i] |= (BUTTON_CNT_PIN >> (BUTTON_CNT_FIRST_BIT + i))
-				& 0x01;
-		// Mask the first WAIT_SAMPLES + 1 bits
-		maskedValue = button_cnt_states[i]
-				& ((1 << (BUTTON_CNT_WAIT_SAMPLES + 1)) - 1);
-		// Check if the masked value equals 10...0
-		pressed |= (maskedValue == (1 << BUTTON_CNT_WAIT_SAMPLES)) << i;
+	button_cnt_time++;
+
+	// Reset the counter of every pin which equals its debounced state and
+	// increment every other counter
+	delta = BUTTON_CNT_PIN ^ button_cnt_state;
+	button_cnt_count1 = (button_cnt_count1 ^ button_cnt_count0) & delta;
+	button_cnt_count0 = ~button_cnt_count0 & delta;
+
+	// Take the new state of every counter which wrapped around
+	toggle = delta & ~(button_cnt_count0 | button_cnt_count1);
+	button_cnt_state ^= toggle;
+
+	// A falling edge of the debounced state indicates a pressed button
+	pressed = ((toggle & ~button_cnt_state) & BUTTON_CNT_MASK)
+			>> BUTTON_CNT_FIRST_BIT;
+	released = ((toggle & button_cnt_state) & BUTTON_CNT_MASK)
+			>> BUTTON_CNT_FIRST_BIT;
+
+	// Skip the event processing unless a button is held or changed
+	if ((~button_cnt_state | toggle) & BUTTON_CNT_MASK) {
+		pressed |= button_cnt_processHeld(pressed, released);
 	}
 
 	if (pressed & 0x02) // Up
@@ -108,3 +183,90 @@ void button_cnt_timedFastTick(void) {
 uint16_t button_cnt_getCounter(void) {
 	return button_cnt_value;
 }
+
+uint8_t button_cnt_getEventCount(void) {
+	return button_cnt_queueCount;
+}
+
+uint8_t button_cnt_popEvent(button_cnt_event_t *event) {
+	if (button_cnt_queueCount == 0) {
+		return 0;
+	}
+
+	*event = button_cnt_queue[button_cnt_queueFirst];
+	button_cnt_queueFirst = (button_cnt_queueFirst + 1) % BUTTON_CNT_QUEUE_SIZE;
+	button_cnt_queueCount--;
+	return 1;
+}
+
+uint8_t button_cnt_fetchOverflows(void) {
+	uint8_t overflows = button_cnt_overflows;
+
+	button_cnt_overflows = 0;
+	return overflows;
+}
+
+/**
+ * \brief Queues the events of every changed or held button
+ * \details The function maintains the long press and auto-repeat timers of
+ * each held button.
+ * \param pressed A bit mask of the buttons which were pressed
+ * \param released A bit mask of the buttons which were released
+ * \return A bit mask of the buttons which were auto-repeated
+ */
+static uint8_t button_cnt_processHeld(uint8_t pressed, uint8_t released) {
+	uint8_t held = (~button_cnt_state & BUTTON_CNT_MASK) >> BUTTON_CNT_FIRST_BIT;
+	uint8_t repeated = 0;
+	uint8_t i;
+
+	for (i = 0; i < BUTTON_CNT_CHANNELS; i++) {
+		if (pressed & _BV(i)) {
+			button_cnt_pushEvent(BUTTON_CNT_PRESS, i);
+			button_cnt_holdTicks[i] = BUTTON_CNT_LONG_TICKS;
+			button_cnt_longPressed &= ~_BV(i);
+
+		} else if (released & _BV(i)) {
+			button_cnt_pushEvent(BUTTON_CNT_RELEASE, i);
+
+		} else if (held & _BV(i)) {
+			button_cnt_holdTicks[i]--;
+			if (button_cnt_holdTicks[i] == 0) {
+				if (button_cnt_longPressed & _BV(i)) {
+					button_cnt_pushEvent(BUTTON_CNT_REPEAT, i);
+					repeated |= _BV(i);
+				} else {
+					button_cnt_pushEvent(BUTTON_CNT_LONG_PRESS, i);
+					button_cnt_longPressed |= _BV(i);
+				}
+				button_cnt_holdTicks[i] = BUTTON_CNT_REPEAT_TICKS;
+			}
+		}
+	}
+
+	return repeated;
+}
+
+/**
+ * \brief Appends an event to the event queue
+ * \details If the queue is full, the event is discarded and counted.
+ * \param type The type of the event
+ * \param button The number of the button
+ */
+static void button_cnt_pushEvent(uint8_t type, uint8_t button) {
+	button_cnt_event_t *event;
+
+	if (button_cnt_queueCount >= BUTTON_CNT_QUEUE_SIZE) {
+		DEBUG_PRINT(0x05, type);
+		if (button_cnt_overflows < UINT8_MAX) {
+			button_cnt_overflows++;
+		}
+		return;
+	}
+
+	event = &button_cnt_queue[(button_cnt_queueFirst + button_cnt_queueCount)
+			% BUTTON_CNT_QUEUE_SIZE];
+	event->type = type;
+	event->button = button;
+	event->time = button_cnt_time;
+	button_cnt_queueCount++;
+}
@@ -3,7 +3,8 @@
  * \brief The file specifies an interface for a simple button counter.
  * \details The module maintains an internal counter which may be increased and
  * decreased by external buttons. Additionally, a third button is evaluated
- * which may generate further events.
+ * which may generate further events. Every press, release, long press and
+ * auto-repeat is recorded in an event queue together with its time stamp.
  * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
  *
  * Copyright (C) 2016 Michael Spiegel
@@ -26,6 +27,34 @@
 
 #include <stdint.h>
 
+/** \brief The maximum number of queued button events */
+#define BUTTON_CNT_QUEUE_SIZE (8)
+
+/** \brief Defines the type of a button event */
+typedef enum {
+	BUTTON_CNT_PRESS = 1, ///< The button was pressed
+	BUTTON_CNT_RELEASE = 2, ///< The button was released
+	BUTTON_CNT_LONG_PRESS = 3, ///< The button is held for a long time
+	BUTTON_CNT_REPEAT = 4 ///< The button is still held after a long press
+} button_cnt_eventType_t;
+
+/**
+ * \brief Flag which is added to the event type if events were discarded
+ * \details The flag marks the oldest event which is fetched after the queue
+ * overflowed. See \ref button_cnt_fetchOverflows.
+ */
+#define BUTTON_CNT_OVERFLOW_FLAG (0x80)
+
+/** \brief Holds a single button event */
+typedef struct {
+	/** \brief The type of the event, see \ref button_cnt_eventType_t */
+	uint8_t type;
+	/** \brief The button number: 0 (ok), 1 (up) or 2 (down) */
+	uint8_t button;
+	/** \brief The number of fast system timer ticks since the initialization */
+	uint16_t time;
+} button_cnt_event_t;
+
 /**
  * \brief Function type which is used to notify the callee
  * \details The function is used to indicate state changes initiated by a user
@@ -33,7 +62,8 @@
  * \param cnt The current internal counter value
  * \param btn A bit mask of the buttons which trigger the event. The LSB is
  * associated with the "ok" button, the second bit is associated with the "up"
- * button and the third bit is associated with the "down" button.
+ * button and the third bit is associated with the "down" button. A bit is set
+ * if the button was pressed or auto-repeated.
  */
 typedef void (*button_cnt_callback_t)(int16_t cnt, uint8_t btn);
 
@@ -58,4 +88,28 @@ void button_cnt_timedFastTick(void);
  */
 uint16_t button_cnt_getCounter(void);
 
+/**
+ * \brief Returns the number of queued events
+ * \return The number of events which may be fetched by
+ * \ref button_cnt_popEvent.
+ */
+uint8_t button_cnt_getEventCount(void);
+
+/**
+ * \brief Removes the oldest event from the event queue
+ * \details If the queue is full, further events are discarded until an event
+ * is removed. The function must not be called from an interrupt context.
+ * \param event Receives the oldest event
+ * \return Non-zero if and only if an event was removed
+ */
+uint8_t button_cnt_popEvent(button_cnt_event_t *event);
+
+/**
+ * \brief Returns and resets the number of discarded events
+ * \details An event is discarded if the queue is full. The number saturates
+ * at 255. The function must not be called from an interrupt context.
+ * \return The number of events which were discarded since the previous call
+ */
+uint8_t button_cnt_fetchOverflows(void);
+
 #endif /* BUTTON_CNT_H_ */
@@ -0,0 +1,94 @@
+/**
+ * \file deferred.c
+ * \brief Implements the queue of deferred work items
+ * \details The queue is a ring buffer which is accessed atomically. The work
+ * items themselves are executed with interrupts enabled.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "deferred.h"
+
+#include <util/atomic.h>
+#include <stdint.h>
+
+#if DEFERRED_QUEUE_SIZE & (DEFERRED_QUEUE_SIZE - 1)
+#error "DEFERRED_QUEUE_SIZE has to be a power of two"
+#endif
+
+/** \brief Holds a single work item */
+typedef struct {
+	deferred_work_t work; ///< The function to execute
+	uint8_t arg; ///< The argument of the function
+} deferred_item_t;
+
+/** \brief The pending work items */
+static volatile deferred_item_t deferred_queue[DEFERRED_QUEUE_SIZE];
+
+/** \brief The index of the oldest pending work item */
+static volatile uint8_t deferred_head;
+
+/** \brief The number of pending work items */
+static volatile uint8_t deferred_count;
+
+void deferred_init(void) {
+	deferred_head = 0;
+	deferred_count = 0;
+}
+
+status_t deferred_post(deferred_work_t work, uint8_t arg) {
+	uint8_t index;
+	status_t ret = err_sizeOutOfBounds;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (deferred_count < DEFERRED_QUEUE_SIZE) {
+			index = (deferred_head + deferred_count) & (DEFERRED_QUEUE_SIZE - 1);
+			deferred_queue[index].work = work;
+			deferred_queue[index].arg = arg;
+			deferred_count++;
+			ret = success;
+		}
+	}
+
+	return ret;
+}
+
+void deferred_tick(void) {
+	uint8_t pending;
+	deferred_work_t work;
+	uint8_t arg;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		pending = deferred_count;
+	}
+
+	while (pending > 0) {
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			work = deferred_queue[deferred_head].work;
+			arg = deferred_queue[deferred_head].arg;
+			deferred_head = (deferred_head + 1) & (DEFERRED_QUEUE_SIZE - 1);
+			deferred_count--;
+		}
+
+		work(arg);
+		pending--;
+	}
+}
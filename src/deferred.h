@@ -0,0 +1,77 @@
+/**
+ * \file deferred.h
+ * \brief Specifies a queue of deferred work items
+ * \details The module implements the bottom half of the interrupt driven
+ * drivers. An interrupt routine only captures the time critical data and posts
+ * a work item which finishes the operation. The work items are executed by
+ * deferred_tick() in the main loop. Hence, completion callbacks never run in an
+ * interrupt context and the interrupt routines stay short. The queue has a
+ * fixed size which must cover every work item that may be pending at once.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef DEFERRED_H_
+#define DEFERRED_H_
+
+#include "error.h"
+
+#include <stdint.h>
+
+/**
+ * \brief The maximum number of pending work items
+ * \details The size has to cover the sum of the items which every producer
+ * posts at the same time. The sum is checked by the main module.
+ */
+#define DEFERRED_QUEUE_SIZE (4)
+
+/**
+ * \brief Defines the type of a deferred work item
+ * \details The function is executed outside an interrupt context with global
+ * interrupts enabled.
+ * \param arg The argument which was given on posting the work item
+ */
+typedef void (*deferred_work_t)(uint8_t arg);
+
+/**
+ * \brief Initializes the module
+ * \details The function has to be called before any other function is used.
+ * Initially, the queue is empty.
+ */
+void deferred_init(void);
+
+/**
+ * \brief Appends a work item to the queue
+ * \details The function may be called in an interrupt context. The work item
+ * is executed by the next invocation of deferred_tick().
+ * \param work The function to execute
+ * \param arg The argument which is passed to the function
+ * \return The status of the operation. err_sizeOutOfBounds indicates that the
+ * queue is full and that the work item was dropped. The producers which post
+ * from an interrupt context rely on \ref DEFERRED_QUEUE_SIZE instead.
+ */
+status_t deferred_post(deferred_work_t work, uint8_t arg);
+
+/**
+ * \brief Executes every pending work item
+ * \details The function has to be called frequently in the main loop. Work
+ * items are executed in the order they were posted. Items which are posted
+ * while the queue is processed are executed by the next invocation.
+ */
+void deferred_tick(void);
+
+#endif /* DEFERRED_H_ */
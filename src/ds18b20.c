@@ -0,0 +1,654 @@
+/**
+ * \file ds18b20.c
+ * \brief Implements the module which drives the DS18B20 sensors
+ * \details The module is split into two layers. The interrupt routine of the
+ * timer executes a single 1-Wire transfer: a reset pulse, a sequence of
+ * written or read bytes or a single step of the ROM search. Each time slot is
+ * started by a timer interrupt. Only the short parts of a slot, which are
+ * below ten microseconds, are timed by busy waiting. After the transfer is
+ * finished, a deferred work item continues the read cycle outside the
+ * interrupt context. Since the bus idles between two time slots, the latency
+ * of the main loop doesn't affect the transfer. The module occupies the
+ * following hardware resources:
+ * <ul>
+ *   <li>PD4: 1-Wire data line, requires an external 4.7k pull-up resistor</li>
+ *   <li>16-bit Timer/Counter 1</li>
+ * </ul>
+ * It is assumed that the hardware resources are not shared. The sensors have
+ * to be powered externally.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ds18b20.h"
+#include "deferred.h"
+#include "system_timer.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <util/crc16.h>
+#include <stdint.h>
+
+#ifndef F_CPU
+#warning "The CPU frequency F_CPU is not defined. Assume 8 MHz."
+#define F_CPU (8000000UL)
+#endif
+
+/** \brief The data line of the bus */
+#define DS18B20_PIN_BIT (_BV(PD4))
+
+/** \brief Pulls the data line low */
+#define DS18B20_PULL_LOW() do { DDRD |= DS18B20_PIN_BIT; } while (0)
+/** \brief Releases the data line, the external pull-up sets it high */
+#define DS18B20_RELEASE() do { DDRD &= ~DS18B20_PIN_BIT; } while (0)
+/** \brief Evaluates to non-zero if the data line is driven low */
+#define DS18B20_IS_LOW() (DDRD & DS18B20_PIN_BIT)
+
+/** \brief The prescaler of the timer */
+#define DS18B20_PRESCALER (8UL)
+
+/**
+ * \brief returns the compare value of the given interval
+ * \param us The interval in microseconds
+ */
+#define DS18B20_US_TO_TICKS(us) \
+	((uint16_t) ((F_CPU/DS18B20_PRESCALER*(us) + 999999UL)/1000000UL - 1))
+
+/** \brief The duration of the reset pulse in microseconds */
+#define DS18B20_RESET_US (480UL)
+/** \brief The delay of the presence sample after the reset pulse */
+#define DS18B20_PRESENCE_US (70UL)
+/** \brief The remaining time of the presence pulse */
+#define DS18B20_PRESENCE_END_US (410UL)
+/** \brief The duration of a time slot including the recovery time */
+#define DS18B20_SLOT_US (70UL)
+/** \brief The duration of the low pulse which starts a read or a 1 slot */
+#define DS18B20_START_US (2)
+/** \brief The delay between releasing the line and sampling a read slot */
+#define DS18B20_SAMPLE_US (9)
+/** \brief The recovery time after a 0 slot */
+#define DS18B20_RECOVERY_US (2)
+
+/** \brief The maximal duration of a conversion in milliseconds */
+#define DS18B20_CONVERSION_MS (750)
+
+/** \brief Addresses every sensor on the bus */
+#define DS18B20_CMD_SKIP_ROM (0xCC)
+/** \brief Addresses a single sensor by its ROM code */
+#define DS18B20_CMD_MATCH_ROM (0x55)
+/** \brief Starts the ROM search */
+#define DS18B20_CMD_SEARCH_ROM (0xF0)
+/** \brief Starts the temperature conversion */
+#define DS18B20_CMD_CONVERT (0x44)
+/** \brief Reads the scratchpad of the sensor */
+#define DS18B20_CMD_READ_SCRATCHPAD (0xBE)
+
+/** \brief The family code of the DS18B20 */
+#define DS18B20_FAMILY_CODE (0x28)
+/** \brief The number of bytes of a ROM code */
+#define DS18B20_ROM_SIZE (8)
+/** \brief The number of bytes of the scratchpad including the CRC byte */
+#define DS18B20_SCRATCHPAD_SIZE (9)
+/** \brief The size of the transfer buffer */
+#define DS18B20_BUFFER_SIZE (DS18B20_ROM_SIZE + 2)
+
+/** \brief Issues a reset pulse and detects the presence pulse */
+#define OP_RESET (0)
+/** \brief Writes the bytes of the transfer buffer */
+#define OP_WRITE (1)
+/** \brief Reads bytes into the transfer buffer */
+#define OP_READ (2)
+/** \brief Reads a ROM bit and its complement and writes the direction */
+#define OP_TRIPLET (3)
+
+/** \brief The result bit which indicates a presence pulse */
+#define RESULT_PRESENCE (0x01)
+/** \brief The result bit which holds the read ROM bit */
+#define RESULT_ID (0x01)
+/** \brief The result bit which holds the complement of the read ROM bit */
+#define RESULT_CMP (0x02)
+/** \brief The result bit which holds the chosen direction */
+#define RESULT_DIR (0x04)
+
+/** \brief Nothing to do */
+#define STATE_IDLE (0)
+/** \brief Issues the reset pulse of a search pass */
+#define STATE_SEARCH_RESET (1)
+/** \brief Writes the search command */
+#define STATE_SEARCH_COMMAND (2)
+/** \brief Determines the ROM code bit by bit */
+#define STATE_SEARCH_TRIPLET (3)
+/** \brief Issues the reset pulse of the conversion */
+#define STATE_CONVERT_RESET (4)
+/** \brief Writes the conversion command */
+#define STATE_CONVERT_COMMAND (5)
+/** \brief Waits until the conversion finished */
+#define STATE_CONVERT_WAIT (6)
+/** \brief Issues the reset pulse before reading a sensor */
+#define STATE_READ_RESET (7)
+/** \brief Writes the ROM code and the read command */
+#define STATE_READ_COMMAND (8)
+/** \brief Reads the scratchpad */
+#define STATE_READ_DATA (9)
+
+/** \brief The current transfer of the interrupt routine */
+static volatile uint8_t ds18b20_op;
+/** \brief The current phase of the reset pulse */
+static volatile uint8_t ds18b20_phase;
+/** \brief The number of the current bit of the transfer */
+static volatile uint8_t ds18b20_bitNr;
+/** \brief The number of bits of the transfer */
+static volatile uint8_t ds18b20_bitCount;
+/** \brief The result of the transfer, see RESULT_x */
+static volatile uint8_t ds18b20_result;
+/** \brief The bytes which are written or read */
+static volatile uint8_t ds18b20_buffer[DS18B20_BUFFER_SIZE];
+
+/** \brief The state of the read cycle */
+static uint8_t ds18b20_state;
+/** \brief The channels which still have to be read */
+static uint8_t ds18b20_requested;
+/** \brief The currently read channel */
+static uint8_t ds18b20_channel;
+/** \brief The assigned callback function */
+static sensor_readDone_t ds18b20_callback;
+/** \brief The ROM codes of the found sensors */
+static uint8_t ds18b20_rom[DS18B20_MAX_SENSORS][DS18B20_ROM_SIZE];
+/** \brief The number of found sensors */
+static uint8_t ds18b20_romCount;
+/** \brief Flag which indicates that the bus has to be searched */
+static uint8_t ds18b20_rescan;
+/** \brief Flag which indicates that a conversion was started */
+static uint8_t ds18b20_converted;
+/** \brief The number of system timer ticks until the conversion finished */
+static uint8_t ds18b20_waitTicks;
+/** \brief The ROM code of the current search pass */
+static uint8_t ds18b20_searchRom[DS18B20_ROM_SIZE];
+/** \brief The bit number of the current search step */
+static uint8_t ds18b20_searchBit;
+/**
+ * \brief The one based position of the last discrepancy which was resolved
+ * with a zero bit in the previous search pass
+ */
+static uint8_t ds18b20_lastDiscrepancy;
+/** \brief The one based position of the last zero discrepancy of the pass */
+static uint8_t ds18b20_lastZero;
+
+const sensor_driver_t ds18b20_driver = { ds18b20_startReading, 1 };
+
+/* Function prototypes */
+static void ds18b20_begin(uint8_t arg);
+static void ds18b20_transfer(uint8_t op, uint8_t bitCount);
+static void ds18b20_continue(uint8_t result);
+static void ds18b20_searchNext(void);
+static void ds18b20_searchStep(void);
+static void ds18b20_searchDone(void);
+static void ds18b20_convert(void);
+static void ds18b20_proceed(void);
+static void ds18b20_readNext(void);
+static void ds18b20_report(status_t status, int16_t value);
+static void ds18b20_failAll(status_t status);
+static uint8_t ds18b20_crc(volatile uint8_t *data, uint8_t size);
+
+void ds18b20_init(void) {
+	// Release the data line, the external resistor pulls it up
+	DDRD &= ~DS18B20_PIN_BIT;
+	PORTD &= ~DS18B20_PIN_BIT;
+
+	// Stop the timer
+	TIMSK &= ~_BV(OCIE1A);
+	TCCR1A = 0;
+	TCCR1B = 0;
+
+	ds18b20_state = STATE_IDLE;
+	ds18b20_requested = 0;
+	ds18b20_romCount = 0;
+	ds18b20_rescan = 1;
+	ds18b20_converted = 0;
+	ds18b20_waitTicks = 0;
+}
+
+status_t ds18b20_startReading(uint8_t channels, sensor_readDone_t callback) {
+	status_t status;
+
+	if (channels == 0 || (channels & ~((1 << DS18B20_MAX_SENSORS) - 1))) {
+		return err_invalidChannel;
+	}
+	if (ds18b20_requested) {
+		return err_invalidState;
+	}
+
+	// A running background conversion continues with the requested channels
+	if (ds18b20_state == STATE_IDLE) {
+		status = deferred_post(ds18b20_begin, 0);
+		if (status != success) {
+			return status;
+		}
+	}
+
+	ds18b20_callback = callback;
+	ds18b20_requested = channels;
+	return success;
+}
+
+void ds18b20_timedTick(void) {
+	if (ds18b20_waitTicks > 0) {
+		ds18b20_waitTicks--;
+		if (ds18b20_waitTicks == 0 && ds18b20_state == STATE_CONVERT_WAIT) {
+			ds18b20_readNext();
+		}
+	}
+}
+
+/**
+ * \brief Begins the requested read cycle
+ * \details The function is executed as deferred work item. Hence, the callback
+ * function is never invoked before \ref ds18b20_startReading returned.
+ * \param arg Unused
+ */
+static void ds18b20_begin(uint8_t arg) {
+	if (ds18b20_rescan) {
+		ds18b20_romCount = 0;
+		ds18b20_lastDiscrepancy = 0;
+		ds18b20_searchNext();
+	} else {
+		ds18b20_proceed();
+	}
+}
+
+/**
+ * \brief Starts a single transfer
+ * \details The transfer buffer has to be prepared before. The first interrupt
+ * is triggered immediately. As soon as the transfer is finished,
+ * ds18b20_continue() is posted as deferred work item.
+ * \param op The transfer type, see OP_x
+ * \param bitCount The number of bits to transfer. It is ignored by OP_RESET and
+ * OP_TRIPLET.
+ */
+static void ds18b20_transfer(uint8_t op, uint8_t bitCount) {
+	uint8_t i;
+
+	if (op == OP_READ) {
+		for (i = 0; i < DS18B20_BUFFER_SIZE; i++) {
+			ds18b20_buffer[i] = 0;
+		}
+	}
+
+	ds18b20_op = op;
+	ds18b20_phase = 0;
+	ds18b20_bitNr = 0;
+	ds18b20_bitCount = (op == OP_TRIPLET ? 3 : bitCount);
+	ds18b20_result = 0;
+
+	// CTC mode, prescaler 8
+	TCNT1 = 0;
+	OCR1A = DS18B20_US_TO_TICKS(DS18B20_START_US);
+	TCCR1A = 0;
+	TCCR1B = _BV(WGM12) | _BV(CS11);
+	TIFR = _BV(OCF1A);
+	TIMSK |= _BV(OCIE1A);
+}
+
+/**
+ * \brief Executes the next step of the current transfer
+ * \details The reset pulse is split into three phases. Any other transfer
+ * executes a single time slot per interrupt. A 0 slot keeps the line low until
+ * the next interrupt. A read or a 1 slot releases the line after a short pulse
+ * and samples the line if required.
+ *
+ * The slot timing must not be stretched. Hence, the routine blocks every other
+ * interrupt while it busy-waits for up to 13 us, i.e. the recovery time of a
+ * 0 slot followed by the sample delay of a read slot. The delay would distort
+ * the edge time stamps of the AM2303, which tolerate about 20 us between the
+ * short and the long bit. Therefore, the main module starts the 1-Wire
+ * traffic only after every AM2303 channel completed its read cycle. A byte of
+ * the USART arrives every 87 us and isn't lost either.
+ */
+ISR(TIMER1_COMPA_vect, ISR_BLOCK) {
+	uint8_t bit, sample;
+
+	if (ds18b20_op == OP_RESET) {
+		switch (ds18b20_phase++) {
+		case 0:
+			DS18B20_PULL_LOW();
+			OCR1A = DS18B20_US_TO_TICKS(DS18B20_RESET_US);
+			return;
+		case 1:
+			DS18B20_RELEASE();
+			OCR1A = DS18B20_US_TO_TICKS(DS18B20_PRESENCE_US);
+			return;
+		case 2:
+			ds18b20_result = (PIND & DS18B20_PIN_BIT ? 0 : RESULT_PRESENCE);
+			OCR1A = DS18B20_US_TO_TICKS(DS18B20_PRESENCE_END_US);
+			return;
+		default:
+			break;
+		}
+	} else {
+		// Finish the previous 0 slot
+		if (DS18B20_IS_LOW()) {
+			DS18B20_RELEASE();
+			_delay_us(DS18B20_RECOVERY_US);
+		}
+
+		if (ds18b20_bitNr < ds18b20_bitCount) {
+			OCR1A = DS18B20_US_TO_TICKS(DS18B20_SLOT_US);
+
+			if (ds18b20_op == OP_WRITE) {
+				bit = (ds18b20_buffer[ds18b20_bitNr >> 3] >> (ds18b20_bitNr & 0x07))
+						& 0x01;
+			} else if (ds18b20_op == OP_READ || ds18b20_bitNr < 2) {
+				bit = 1;
+			} else if (ds18b20_result == (RESULT_ID | RESULT_CMP)) {
+				// No sensor responded, abort the search step
+				bit = 1;
+				ds18b20_bitNr = ds18b20_bitCount - 1;
+			} else if (ds18b20_result == 0) {
+				// Discrepancy, the direction was chosen in advance
+				bit = ds18b20_buffer[0];
+			} else {
+				bit = ds18b20_result & RESULT_ID;
+			}
+
+			DS18B20_PULL_LOW();
+			if (bit) {
+				_delay_us(DS18B20_START_US);
+				DS18B20_RELEASE();
+				_delay_us(DS18B20_SAMPLE_US);
+				sample = (PIND & DS18B20_PIN_BIT ? 1 : 0);
+
+				if (ds18b20_op == OP_READ) {
+					ds18b20_buffer[ds18b20_bitNr >> 3] |= sample
+							<< (ds18b20_bitNr & 0x07);
+				} else if (ds18b20_op == OP_TRIPLET && ds18b20_bitNr < 2) {
+					ds18b20_result |= sample << ds18b20_bitNr;
+				}
+			}
+			if (ds18b20_op == OP_TRIPLET && ds18b20_bitNr == 2 && bit) {
+				ds18b20_result |= RESULT_DIR;
+			}
+
+			ds18b20_bitNr++;
+			return;
+		}
+	}
+
+	// The transfer is finished
+	TIMSK &= ~_BV(OCIE1A);
+	TCCR1B = 0;
+	// The queue has room for the transfer, see DS18B20_DEFERRED_ITEMS
+	(void) deferred_post(ds18b20_continue, ds18b20_result);
+}
+
+/**
+ * \brief Continues the read cycle after a transfer was finished
+ * \details The function is executed as deferred work item.
+ * \param result The result of the transfer, see RESULT_x
+ */
+static void ds18b20_continue(uint8_t result) {
+	uint8_t i;
+	int16_t raw;
+
+	switch (ds18b20_state) {
+	case STATE_SEARCH_RESET:
+		if (result & RESULT_PRESENCE) {
+			ds18b20_state = STATE_SEARCH_COMMAND;
+			ds18b20_buffer[0] = DS18B20_CMD_SEARCH_ROM;
+			ds18b20_transfer(OP_WRITE, 8);
+		} else {
+			ds18b20_searchDone();
+		}
+		break;
+
+	case STATE_SEARCH_COMMAND:
+		ds18b20_state = STATE_SEARCH_TRIPLET;
+		ds18b20_searchBit = 0;
+		ds18b20_lastZero = 0;
+		ds18b20_searchStep();
+		break;
+
+	case STATE_SEARCH_TRIPLET:
+		if ((result & (RESULT_ID | RESULT_CMP)) == (RESULT_ID | RESULT_CMP)) {
+			// No sensor responded
+			ds18b20_searchDone();
+			break;
+		}
+		if ((result & (RESULT_ID | RESULT_CMP)) == 0 && !(result & RESULT_DIR)) {
+			ds18b20_lastZero = ds18b20_searchBit + 1;
+		}
+		if (result & RESULT_DIR) {
+			ds18b20_searchRom[ds18b20_searchBit >> 3] |= 1
+					<< (ds18b20_searchBit & 0x07);
+		} else {
+			ds18b20_searchRom[ds18b20_searchBit >> 3] &= ~(1
+					<< (ds18b20_searchBit & 0x07));
+		}
+
+		ds18b20_searchBit++;
+		if (ds18b20_searchBit < DS18B20_ROM_SIZE * 8) {
+			ds18b20_searchStep();
+			break;
+		}
+
+		// The ROM code is complete
+		ds18b20_lastDiscrepancy = ds18b20_lastZero;
+		if (ds18b20_crc(ds18b20_searchRom, DS18B20_ROM_SIZE) == 0
+				&& ds18b20_searchRom[0] == DS18B20_FAMILY_CODE) {
+			for (i = 0; i < DS18B20_ROM_SIZE; i++) {
+				ds18b20_rom[ds18b20_romCount][i] = ds18b20_searchRom[i];
+			}
+			ds18b20_romCount++;
+		}
+		if (ds18b20_lastDiscrepancy == 0
+				|| ds18b20_romCount == DS18B20_MAX_SENSORS) {
+			ds18b20_searchDone();
+		} else {
+			ds18b20_searchNext();
+		}
+		break;
+
+	case STATE_CONVERT_RESET:
+		if (result & RESULT_PRESENCE) {
+			ds18b20_state = STATE_CONVERT_COMMAND;
+			ds18b20_buffer[0] = DS18B20_CMD_SKIP_ROM;
+			ds18b20_buffer[1] = DS18B20_CMD_CONVERT;
+			ds18b20_transfer(OP_WRITE, 16);
+		} else {
+			ds18b20_converted = 0;
+			ds18b20_failAll(err_noSignal);
+		}
+		break;
+
+	case STATE_CONVERT_COMMAND:
+		ds18b20_converted = 1;
+		// The next tick may follow immediately
+		ds18b20_waitTicks = SYSTEM_TIMER_MS_TO_TICKS(DS18B20_CONVERSION_MS) + 1;
+		ds18b20_state = (ds18b20_requested ? STATE_CONVERT_WAIT : STATE_IDLE);
+		break;
+
+	case STATE_READ_RESET:
+		if (result & RESULT_PRESENCE) {
+			ds18b20_state = STATE_READ_COMMAND;
+			ds18b20_buffer[0] = DS18B20_CMD_MATCH_ROM;
+			for (i = 0; i < DS18B20_ROM_SIZE; i++) {
+				ds18b20_buffer[i + 1] = ds18b20_rom[ds18b20_channel][i];
+			}
+			ds18b20_buffer[DS18B20_ROM_SIZE + 1] = DS18B20_CMD_READ_SCRATCHPAD;
+			ds18b20_transfer(OP_WRITE, DS18B20_BUFFER_SIZE * 8);
+		} else {
+			ds18b20_report(err_noSignal, 0);
+		}
+		break;
+
+	case STATE_READ_COMMAND:
+		ds18b20_state = STATE_READ_DATA;
+		ds18b20_transfer(OP_READ, DS18B20_SCRATCHPAD_SIZE * 8);
+		break;
+
+	case STATE_READ_DATA:
+		if (ds18b20_crc(ds18b20_buffer, DS18B20_SCRATCHPAD_SIZE) == 0) {
+			// Convert 1/16 degree to 1/10 degree, round half away from zero
+			raw = ds18b20_buffer[0] | (ds18b20_buffer[1] << 8);
+			ds18b20_report(success,
+					(raw < 0 ? -((-(int32_t) raw * 10 + 8) >> 4) :
+							(((int32_t) raw * 10 + 8) >> 4)));
+		} else {
+			ds18b20_report(err_chksum, 0);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+/** \brief Starts the next pass of the ROM search */
+static void ds18b20_searchNext(void) {
+	ds18b20_state = STATE_SEARCH_RESET;
+	ds18b20_transfer(OP_RESET, 0);
+}
+
+/**
+ * \brief Executes a single step of the ROM search
+ * \details The direction which is taken on a discrepancy is chosen in advance.
+ * Before the last discrepancy of the previous pass, the previous path is
+ * followed. At the last discrepancy, the one branch is taken. Afterwards, the
+ * zero branch is preferred.
+ */
+static void ds18b20_searchStep(void) {
+	uint8_t position = ds18b20_searchBit + 1;
+
+	if (position < ds18b20_lastDiscrepancy) {
+		ds18b20_buffer[0] = (ds18b20_searchRom[ds18b20_searchBit >> 3]
+				>> (ds18b20_searchBit & 0x07)) & 0x01;
+	} else {
+		ds18b20_buffer[0] = (position == ds18b20_lastDiscrepancy ? 1 : 0);
+	}
+	ds18b20_transfer(OP_TRIPLET, 0);
+}
+
+/** \brief Finishes the ROM search and continues the read cycle */
+static void ds18b20_searchDone(void) {
+	ds18b20_rescan = (ds18b20_romCount == 0);
+	if (ds18b20_romCount == 0) {
+		ds18b20_failAll(err_noSignal);
+	} else {
+		ds18b20_proceed();
+	}
+}
+
+/** \brief Starts the conversion of every sensor */
+static void ds18b20_convert(void) {
+	ds18b20_state = STATE_CONVERT_RESET;
+	ds18b20_transfer(OP_RESET, 0);
+}
+
+/**
+ * \brief Reads the requested channels as soon as a conversion result is
+ * available
+ */
+static void ds18b20_proceed(void) {
+	if (!ds18b20_converted) {
+		ds18b20_convert();
+	} else if (ds18b20_waitTicks > 0) {
+		ds18b20_state = STATE_CONVERT_WAIT;
+	} else {
+		ds18b20_readNext();
+	}
+}
+
+/**
+ * \brief Reads the next requested channel
+ * \details If every channel was read, the next conversion is started.
+ */
+static void ds18b20_readNext(void) {
+	if (ds18b20_requested == 0) {
+		ds18b20_convert();
+		return;
+	}
+
+	ds18b20_channel = 0;
+	while (!(ds18b20_requested & (1 << ds18b20_channel))) {
+		ds18b20_channel++;
+	}
+
+	if (ds18b20_channel >= ds18b20_romCount) {
+		// The sensor wasn't found by the last search
+		ds18b20_report(err_noSignal, 0);
+	} else {
+		ds18b20_state = STATE_READ_RESET;
+		ds18b20_transfer(OP_RESET, 0);
+	}
+}
+
+/**
+ * \brief Reports the result of the current channel and reads the next one
+ * \details A failed sensor which was found by the last search triggers a new
+ * search on the next read cycle. A channel without a found sensor doesn't.
+ * Otherwise, every read cycle and retry would search the bus again.
+ * \param status The status of the operation
+ * \param value The temperature in 0.1 degree Celsius
+ */
+static void ds18b20_report(status_t status, int16_t value) {
+	uint8_t channel = ds18b20_channel;
+
+	if (status != success && channel < ds18b20_romCount) {
+		ds18b20_rescan = 1;
+	}
+	ds18b20_requested &= ~(1 << channel);
+	ds18b20_callback(&ds18b20_driver, channel, status, &value);
+	ds18b20_readNext();
+}
+
+/**
+ * \brief Reports the given status for every requested channel
+ * \details Afterwards, the module is idle.
+ * \param status The status to report
+ */
+static void ds18b20_failAll(status_t status) {
+	uint8_t channel;
+	uint8_t requested = ds18b20_requested;
+	int16_t value = 0;
+
+	ds18b20_state = STATE_IDLE;
+	ds18b20_requested = 0;
+	ds18b20_rescan = 1;
+	for (channel = 0; channel < DS18B20_MAX_SENSORS; channel++) {
+		if (requested & (1 << channel)) {
+			ds18b20_callback(&ds18b20_driver, channel, status, &value);
+		}
+	}
+}
+
+/**
+ * \brief Computes the 1-Wire CRC of the given data
+ * \param data The data including the CRC byte
+ * \param size The number of bytes
+ * \return Zero if and only if the CRC is valid
+ */
+static uint8_t ds18b20_crc(volatile uint8_t *data, uint8_t size) {
+	uint8_t crc = 0;
+
+	while (size > 0) {
+		crc = _crc_ibutton_update(crc, *data);
+		data++;
+		size--;
+	}
+	return crc;
+}
@@ -0,0 +1,88 @@
+/**
+ * \file ds18b20.h
+ * \brief Reads the temperature of DS18B20 sensors on a 1-Wire bus
+ * \details The module implements an interrupt driven 1-Wire master. Several
+ * sensors may share the bus. They are discovered by the ROM search and
+ * addressed by their ROM code afterwards. Channel n denotes the n-th sensor
+ * which was found. The conversion of the temperature takes up to 750ms. To
+ * avoid any waiting, every read cycle delivers the result of the conversion
+ * which was started at the end of the previous read cycle. Only the first read
+ * cycle waits for the conversion. The module implements the interface of
+ * \ref sensor.h.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef DS18B20_H_
+#define DS18B20_H_
+
+#include <stdint.h>
+
+#include "error.h"
+#include "sensor.h"
+
+/** \brief The maximal number of sensors on the bus */
+#define DS18B20_MAX_SENSORS (2)
+
+/**
+ * \brief The maximal number of deferred work items which the module posts
+ * at the same time
+ * \details The next bus transfer is started by the previous work item.
+ */
+#define DS18B20_DEFERRED_ITEMS (1)
+
+/**
+ * \brief The driver descriptor of the module
+ * \details Each channel delivers the temperature in 0.1 degree Celsius.
+ */
+extern const sensor_driver_t ds18b20_driver;
+
+/**
+ * \brief Initializes the module
+ * \details The function must be called before calling any other function. It is
+ * assumed that global interrupts are not enabled and that the queue of
+ * \ref deferred.h is initialized. The bus is searched on the first read cycle.
+ */
+void ds18b20_init(void);
+
+/**
+ * \brief Requests the temperature of one or more sensors
+ * \details The selected channels are read one after another. After a channel
+ * was read, the callback function is invoked. If the bus wasn't searched yet
+ * or if a sensor failed before, the bus is searched first. The function must
+ * not be called before the callback function was invoked for every selected
+ * channel of the previous request.
+ * \param channels The channels to read. Bit n selects channel n.
+ * \param callback The callback function which indicates a completed request.
+ * It is invoked by deferred_tick() outside an interrupt context.
+ * \return The status of the operation. err_invalidChannel indicates that no
+ * or an unsupported channel was selected. err_invalidState indicates that the
+ * previous request is still in progress. err_sizeOutOfBounds indicates that
+ * the queue of deferred work items is full. In any of these cases, the callback
+ * function won't be invoked.
+ */
+status_t ds18b20_startReading(uint8_t channels, sensor_readDone_t callback);
+
+/**
+ * \brief The time handler function which needs to be called whenever the
+ * system timer fires.
+ * \details The function times the conversion of the temperature.
+ */
+void ds18b20_timedTick(void);
+
+#endif /* DS18B20_H_ */
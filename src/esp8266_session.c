@@ -118,9 +118,10 @@ static void esp8266_session_statusReceived(status_t status);
 static void esp8266_session_sendCommand_P(const char *command_P);
 static void esp8266_session_handleInitError(void);
 
-void esp8266_session_init(esp8266_transc_messageReceived messageCB) {
+void esp8266_session_init(esp8266_transc_messageReceived messageCB,
+		esp8266_transc_linkChanged linkCB) {
 	// Initialize the transceiver
-	esp8266_transc_init(esp8266_session_statusReceived, messageCB);
+	esp8266_transc_init(esp8266_session_statusReceived, messageCB, linkCB);
 
 	// Wait until the chip has been initialized
 	esp8266_session_remainingTicks = SYSTEM_TIMER_MS_TO_TICKS(1000);
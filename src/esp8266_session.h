@@ -57,8 +57,12 @@ typedef void (*esp8266_session_sendComplete_t)(status_t status);
  * been programmed.</p>
  * \param messageCB The transceiver callback function which indicates a received
  * message. It will be directly passed to \ref esp8266_transc_init.
+ * \param linkCB The transceiver callback function which indicates that a
+ * client connected or disconnected. It will be directly passed to
+ * \ref esp8266_transc_init.
  */
-void esp8266_session_init(esp8266_transc_messageReceived messageCB);
+void esp8266_session_init(esp8266_transc_messageReceived messageCB,
+		esp8266_transc_linkChanged linkCB);
 
 /**
  * \brief Sends the given message
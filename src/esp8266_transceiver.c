@@ -64,6 +64,8 @@ static uint8_t esp8266_transc_nextEcho;
 static esp8266_transc_statusReceived esp8266_transc_statusCB;
 /** \brief Message notification callback function */
 static esp8266_transc_messageReceived esp8266_transc_messageCB;
+/** \brief Link notification callback function */
+static esp8266_transc_linkChanged esp8266_transc_linkCB;
 
 /**
  * \brief The round robin buffer used to store received values
@@ -132,6 +134,13 @@ const char esp8266_transc_str_sendOk[] PROGMEM = "SEND OK";
 const char esp8266_transc_str_noChange[] PROGMEM = "no change";
 /** \brief the received packet message identifier */
 const char esp8266_transc_str_rcv[] PROGMEM = "IPD";
+/** \brief status message which indicates an opened link */
+const char esp8266_transc_str_connect[] PROGMEM = "CONNECT";
+/** \brief status message which indicates a closed link */
+const char esp8266_transc_str_closed[] PROGMEM = "CLOSED";
+
+/** \brief Indicates that the status message doesn't refer to a link */
+#define ESP8266_TRANSC_NO_LINK (0xFF)
 
 /** \brief Adds the two operands modulo the buffer size */
 #define ESP8266_TRANSC_RRADD(a, b) (((a) + (b)) % \
@@ -148,13 +157,16 @@ static void esp8266_transc_decreaseBufferSync(void);
 static uint16_t esp8266_transc_rrStringToNumber(uint8_t rrStart, uint8_t rrEnd);
 static int8_t esp8266_transc_rrstrcmp_PF(uint8_t rrStart, uint8_t rrEnd,
 		const char *ref);
+static uint8_t esp8266_transc_linkChannel(void);
 
 void esp8266_transc_init(esp8266_transc_statusReceived statusCB,
-		esp8266_transc_messageReceived messageCB) {
+		esp8266_transc_messageReceived messageCB,
+		esp8266_transc_linkChanged linkCB) {
 
 	// Initialize variables
 	esp8266_transc_statusCB = statusCB;
 	esp8266_transc_messageCB = messageCB;
+	esp8266_transc_linkCB = linkCB;
 	esp8266_transc_sendBufferSize = 0;
 	esp8266_transc_nextEcho = 0;
 	esp8266_transc_rrFirst = 0;
@@ -256,22 +268,28 @@ static inline void esp8266_transc_processNextChar(void) {
 	case STATUS_MSG: 	// ---------------------------------------------------------
 		if (cChar == '\r') {
 			status_t status = err_status;
+			uint8_t channel = esp8266_transc_linkChannel();
 			// Evaluate status message
-			if (esp8266_transc_rrstrcmp_PF(esp8266_transc_rrFirst,
-					esp8266_transc_rrFirstUnprocessed, esp8266_transc_str_ok) == 0) {
-				status = success;
-			} else if (esp8266_transc_rrstrcmp_PF(esp8266_transc_rrFirst,
-					esp8266_transc_rrFirstUnprocessed, esp8266_transc_str_sendOk) == 0) {
-				status = success;
-			} else if (esp8266_transc_rrstrcmp_PF(esp8266_transc_rrFirst,
-					esp8266_transc_rrFirstUnprocessed, esp8266_transc_str_noChange)
-					== 0) {
-				status = err_noChange;
+			if (channel != ESP8266_TRANSC_NO_LINK) {
+				esp8266_transc_linkCB(channel);
+			} else {
+				if (esp8266_transc_rrstrcmp_PF(esp8266_transc_rrFirst,
+						esp8266_transc_rrFirstUnprocessed, esp8266_transc_str_ok) == 0) {
+					status = success;
+				} else if (esp8266_transc_rrstrcmp_PF(esp8266_transc_rrFirst,
+						esp8266_transc_rrFirstUnprocessed, esp8266_transc_str_sendOk)
+						== 0) {
+					status = success;
+				} else if (esp8266_transc_rrstrcmp_PF(esp8266_transc_rrFirst,
+						esp8266_transc_rrFirstUnprocessed, esp8266_transc_str_noChange)
+						== 0) {
+					status = err_noChange;
+				}
+
+				// Notify via callback
+				esp8266_transc_statusCB(status);
 			}
 
-			// Notify via callback
-			esp8266_transc_statusCB(status);
-
 			esp8266_transc_state = ERR; // consume last \n
 			esp8266_transc_decreaseBufferSync();
 		} else {
@@ -481,6 +499,35 @@ static int8_t esp8266_transc_rrstrcmp_PF(uint8_t rrStart, uint8_t rrEnd,
 
 }
 
+/**
+ * \brief Checks whether the current status message reports a link change
+ * \details The ESP8266 reports a connected client by "<channel>,CONNECT" and
+ * a disconnected client by "<channel>,CLOSED". The status message is stored
+ * between esp8266_transc_rrFirst and esp8266_transc_rrFirstUnprocessed.
+ * \return The channel number of the link or ESP8266_TRANSC_NO_LINK if the
+ * status message doesn't report a link change.
+ */
+static uint8_t esp8266_transc_linkChannel(void) {
+	uint8_t channel = esp8266_transc_rrBuffer[esp8266_transc_rrFirst] - '0';
+	uint8_t code = ESP8266_TRANSC_RRADD(esp8266_transc_rrFirst, 2);
+
+	if (channel >= 4
+			|| ESP8266_TRANSC_RRSUB(esp8266_transc_rrFirstUnprocessed,
+					esp8266_transc_rrFirst) <= 2
+			|| esp8266_transc_rrBuffer[ESP8266_TRANSC_RRADD(esp8266_transc_rrFirst,
+					1)] != ',') {
+		return ESP8266_TRANSC_NO_LINK;
+	}
+	if (esp8266_transc_rrstrcmp_PF(code, esp8266_transc_rrFirstUnprocessed,
+			esp8266_transc_str_connect) == 0
+			|| esp8266_transc_rrstrcmp_PF(code,
+					esp8266_transc_rrFirstUnprocessed, esp8266_transc_str_closed)
+					== 0) {
+		return channel;
+	}
+	return ESP8266_TRANSC_NO_LINK;
+}
+
 /**
  * \brief Processes the newly received byte
  * \details Checks whether the currently received byte is an echoed one. If
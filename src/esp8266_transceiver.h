@@ -40,6 +40,13 @@
  */
 typedef void (*esp8266_transc_statusReceived)(status_t status);
 
+/**
+ * \brief Defines a callback pointer which indicates an opened or closed link
+ * \param channel The channel number of the link. The value ranges from zero to
+ * three.
+ */
+typedef void (*esp8266_transc_linkChanged)(uint8_t channel);
+
 /**
  * \brief Initializes the module
  * \details The function has to be called before any other function is used. It
@@ -50,9 +57,13 @@ typedef void (*esp8266_transc_statusReceived)(status_t status);
  * \param messageCB A callback function which is executed on receiving a new
  * message. The function is always executed outside an interrupt context. Passed
  * memory regions are only valid until the function returns.
+ * \param linkCB A callback function which is executed if a client connected
+ * to or disconnected from the server. The function is executed outside an
+ * interrupt context. The status callback isn't executed for these messages.
  */
 void esp8266_transc_init(esp8266_transc_statusReceived statusCB,
-		esp8266_transc_messageReceived messageCB);
+		esp8266_transc_messageReceived messageCB,
+		esp8266_transc_linkChanged linkCB);
 
 /**
  * \brief Decodes any received message
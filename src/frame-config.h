@@ -0,0 +1,285 @@
+/**
+ * \file frame-config.h
+ * \brief The file contains the layout of every exchanged IEC 61499 message
+ * \details Each layout is a macro which applies the passed FIELD macro to every
+ * data element in transmission order. A field is given by its name and its
+ * IEC 61499 type. The layouts correspond to the data ports of the CLIENT
+ * function block in <code>test/4diac/InterfaceWiFiSensor.xml</code>: the reply
+ * holds the RD_x outputs and the LED command holds the SD_x inputs. The
+ * encoding and decoding functions are derived from the layouts by the frame
+ * macros of \ref iec61499_com.h. Hence, the message layout has to be changed
+ * here only.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef FRAME_CONFIG_H_
+#define FRAME_CONFIG_H_
+
+#include "iec61499_com.h"
+#include "button_cnt.h"
+
+#ifdef USE_AM2303_CHN1
+/** \brief The reply fields of the second humidity sensor channel */
+#define FRAME_CONFIG_REPLY_CHN1(FIELD) \
+	FIELD(temperatureChn1, INT) \
+	FIELD(humidityChn1, INT)
+#else
+#define FRAME_CONFIG_REPLY_CHN1(FIELD)
+#endif
+
+#ifdef USE_BUTTON_CNT
+/**
+ * \brief The field type of the button events
+ * \details Each UDINT element holds the event type in the most significant
+ * byte followed by the button number and the 16 bit time stamp in fast system
+ * timer ticks. A fast tick lasts 256 * 128 / F_CPU seconds, i.e. about
+ * 3.958 ms at the default F_CPU of 8.28 MHz. Hence, the time stamp wraps
+ * around after about 259 s. Unused elements are zero. If events were discarded because the
+ * queue was full, the first element carries \ref BUTTON_CNT_OVERFLOW_FLAG in
+ * its event type.
+ */
+IEC61499_COM_DECLARE_ARRAY(BUTTON_EVENTS, UDINT, BUTTON_CNT_QUEUE_SIZE)
+/** \brief Initializes the field of the button events */
+#define IEC61499_COM_BUTTON_EVENTS_TEMPLATE \
+	IEC61499_COM_ARRAY_TEMPLATE(UDINT, BUTTON_CNT_QUEUE_SIZE)
+
+/** \brief The reply fields of the button counter */
+#define FRAME_CONFIG_REPLY_BUTTON(FIELD) \
+	FIELD(buttonCnt, INT) \
+	FIELD(buttonFlags, INT)
+/** \brief The reply field of the queued button events */
+#define FRAME_CONFIG_REPLY_BUTTON_EVENTS(FIELD) \
+	FIELD(buttonEvents, BUTTON_EVENTS)
+#else
+#define FRAME_CONFIG_REPLY_BUTTON(FIELD)
+#define FRAME_CONFIG_REPLY_BUTTON_EVENTS(FIELD)
+#endif
+
+#ifdef USE_DS18B20
+/** \brief The reply fields of the 1-Wire temperature sensors */
+#define FRAME_CONFIG_REPLY_DS18B20(FIELD) \
+	FIELD(temperatureDs0, INT) \
+	FIELD(temperatureDs1, INT)
+/** \brief The quality fields of the 1-Wire temperature sensors */
+#define FRAME_CONFIG_REPLY_QUALITY_DS18B20(FIELD) \
+	FIELD(qualityDs0, INT) \
+	FIELD(qualityDs1, INT)
+#else
+#define FRAME_CONFIG_REPLY_DS18B20(FIELD)
+#define FRAME_CONFIG_REPLY_QUALITY_DS18B20(FIELD)
+#endif
+
+#ifdef USE_SHT3X
+/** \brief The reply fields of the TWI humidity sensor */
+#define FRAME_CONFIG_REPLY_SHT3X(FIELD) \
+	FIELD(temperatureSht0, INT) \
+	FIELD(humiditySht0, INT)
+/** \brief The quality field of the TWI humidity sensor */
+#define FRAME_CONFIG_REPLY_QUALITY_SHT3X(FIELD) \
+	FIELD(qualitySht0, INT)
+#else
+#define FRAME_CONFIG_REPLY_SHT3X(FIELD)
+#define FRAME_CONFIG_REPLY_QUALITY_SHT3X(FIELD)
+#endif
+
+#ifdef USE_AM2303_CHN1
+/** \brief The quality field of the second humidity sensor channel */
+#define FRAME_CONFIG_REPLY_QUALITY_CHN1(FIELD) \
+	FIELD(qualityChn1, INT)
+#else
+#define FRAME_CONFIG_REPLY_QUALITY_CHN1(FIELD)
+#endif
+
+/**
+ * \brief The reply fields which report the quality of the sensor readings
+ * \details Each field holds the number of consecutive failed read cycles of
+ * the corresponding sensor instance. Zero indicates that the last read cycle
+ * delivered the current values.
+ */
+#define FRAME_CONFIG_REPLY_QUALITY(FIELD) \
+	FIELD(qualityChn0, INT) \
+	FRAME_CONFIG_REPLY_QUALITY_CHN1(FIELD) \
+	FRAME_CONFIG_REPLY_QUALITY_DS18B20(FIELD) \
+	FRAME_CONFIG_REPLY_QUALITY_SHT3X(FIELD)
+
+#ifdef USE_ADC
+/**
+ * \brief The reply fields of the analog channels
+ * \details The fields are assigned to the channels in \ref adc-config.h.
+ */
+#define FRAME_CONFIG_REPLY_ADC(FIELD) \
+	FIELD(lightLevel, INT) \
+	FIELD(supplyVoltage, INT)
+#else
+#define FRAME_CONFIG_REPLY_ADC(FIELD)
+#endif
+
+#ifdef USE_DEW_POINT
+#ifdef USE_AM2303_CHN1
+/** \brief The derived fields of the second humidity sensor channel */
+#define FRAME_CONFIG_REPLY_DEW_POINT_CHN1(FIELD) \
+	FIELD(dewPointChn1, INT) \
+	FIELD(absHumidityChn1, INT)
+#else
+#define FRAME_CONFIG_REPLY_DEW_POINT_CHN1(FIELD)
+#endif
+#ifdef USE_SHT3X
+/** \brief The derived fields of the TWI humidity sensor */
+#define FRAME_CONFIG_REPLY_DEW_POINT_SHT3X(FIELD) \
+	FIELD(dewPointSht0, INT) \
+	FIELD(absHumiditySht0, INT)
+#else
+#define FRAME_CONFIG_REPLY_DEW_POINT_SHT3X(FIELD)
+#endif
+
+/**
+ * \brief The reply fields which are derived from the humidity readings
+ * \details Each dew point is given in 0.1 degree Celsius and each absolute
+ * humidity in 0.01 g/m^3.
+ */
+#define FRAME_CONFIG_REPLY_DEW_POINT(FIELD) \
+	FIELD(dewPointChn0, INT) \
+	FIELD(absHumidityChn0, INT) \
+	FRAME_CONFIG_REPLY_DEW_POINT_CHN1(FIELD) \
+	FRAME_CONFIG_REPLY_DEW_POINT_SHT3X(FIELD)
+#else
+#define FRAME_CONFIG_REPLY_DEW_POINT(FIELD)
+#endif
+
+#ifdef USE_AM2303_CHN1
+/** \brief The read statistics of the second humidity sensor channel */
+#define FRAME_CONFIG_REPLY_STATISTICS_CHN1(FIELD) \
+	FIELD(readsChn1, UINT) \
+	FIELD(chksumErrorsChn1, UINT)
+#else
+#define FRAME_CONFIG_REPLY_STATISTICS_CHN1(FIELD)
+#endif
+
+/**
+ * \brief The reply fields which report the read statistics of the humidity
+ * sensor channels
+ * \details The fields hold the number of completed read cycles and the number
+ * of read cycles with an invalid checksum. The counters wrap around. Hence,
+ * rates have to be computed from the difference of two consecutive replies.
+ */
+#define FRAME_CONFIG_REPLY_STATISTICS(FIELD) \
+	FIELD(readsChn0, UINT) \
+	FIELD(chksumErrorsChn0, UINT) \
+	FRAME_CONFIG_REPLY_STATISTICS_CHN1(FIELD)
+
+/**
+ * \brief The reply fields which are sent unless a client selects its own
+ * fields
+ * \details The fields form the prefix of the reply. Hence, the default reply
+ * is sent straight from the pre-encoded buffer. New default fields are
+ * appended to this list.
+ */
+#define FRAME_CONFIG_REPLY_DEFAULT(FIELD) \
+	FIELD(temperatureChn0, INT) \
+	FIELD(humidityChn0, INT) \
+	FRAME_CONFIG_REPLY_CHN1(FIELD) \
+	FRAME_CONFIG_REPLY_BUTTON(FIELD) \
+	FRAME_CONFIG_REPLY_DS18B20(FIELD) \
+	FRAME_CONFIG_REPLY_SHT3X(FIELD) \
+	FRAME_CONFIG_REPLY_ADC(FIELD)
+
+/**
+ * \brief The reply fields which have to be selected by a field mask request
+ * \details The fields follow the default fields. Hence, the field mask bits
+ * of the optional fields depend on the enabled default fields.
+ */
+#define FRAME_CONFIG_REPLY_OPTIONAL(FIELD) \
+	FRAME_CONFIG_REPLY_BUTTON_EVENTS(FIELD) \
+	FRAME_CONFIG_REPLY_QUALITY(FIELD) \
+	FRAME_CONFIG_REPLY_DEW_POINT(FIELD) \
+	FRAME_CONFIG_REPLY_STATISTICS(FIELD)
+
+/**
+ * \brief The layout of the reply which is sent to the controller
+ * \details The default fields are followed by the optional fields.
+ */
+#define FRAME_CONFIG_REPLY(FIELD) \
+	FRAME_CONFIG_REPLY_DEFAULT(FIELD) \
+	FRAME_CONFIG_REPLY_OPTIONAL(FIELD)
+
+/**
+ * \brief The layout of the LED command which is received from the controller
+ * \details The position denotes the pixel number and the update flag indicates
+ * whether the LED chain should be updated.
+ */
+#define FRAME_CONFIG_WS2801(FIELD) \
+	FIELD(position, USINT) \
+	FIELD(red, USINT) \
+	FIELD(green, USINT) \
+	FIELD(blue, USINT) \
+	FIELD(update, BOOL)
+
+/**
+ * \brief The layout of the LED range fill command
+ * \details The count consecutive pixels starting at position are set to the
+ * same color. The command is distinguished from \ref FRAME_CONFIG_WS2801 by its
+ * size. The batch command, which sets a sequence of individual colors, holds an
+ * ARRAY of USINT red, green and blue triples after the position. Since the
+ * length of the array varies, its layout is decoded by hand.
+ */
+#define FRAME_CONFIG_WS2801_FILL(FIELD) \
+	FIELD(position, USINT) \
+	FIELD(count, USINT) \
+	FIELD(red, USINT) \
+	FIELD(green, USINT) \
+	FIELD(blue, USINT) \
+	FIELD(update, BOOL)
+
+/**
+ * \brief The layout of the LED palette command
+ * \details The command sets the color of the palette entry at the given index.
+ * It is only accepted if the LED controller runs in palette mode.
+ */
+#define FRAME_CONFIG_WS2801_PALETTE(FIELD) \
+	FIELD(index, USINT) \
+	FIELD(red, USINT) \
+	FIELD(green, USINT) \
+	FIELD(blue, USINT)
+
+/**
+ * \brief The layout of the LED brightness command
+ * \details The brightness scales every gamma corrected color. It is only
+ * accepted if the color correction is enabled.
+ */
+#define FRAME_CONFIG_WS2801_BRIGHTNESS(FIELD) \
+	FIELD(brightness, USINT) \
+	FIELD(update, BOOL)
+
+/**
+ * \brief The layout of the LED animation command
+ * \details The mode selects the animation and the period is given in
+ * milliseconds. The first color is the primary color and the second color is
+ * the secondary color of the animation. The command is only accepted if the
+ * animation engine is enabled.
+ */
+#define FRAME_CONFIG_WS2801_ANIMATION(FIELD) \
+	FIELD(mode, USINT) \
+	FIELD(period, UINT) \
+	FIELD(red, USINT) \
+	FIELD(green, USINT) \
+	FIELD(blue, USINT) \
+	FIELD(redSecondary, USINT) \
+	FIELD(greenSecondary, USINT) \
+	FIELD(blueSecondary, USINT)
+
+#endif /* FRAME_CONFIG_H_ */
@@ -0,0 +1,120 @@
+/**
+ * \file humidity.c
+ * \brief Implements the computation of the dew point and the absolute humidity
+ * \details The partial pressure of the water vapour is the product of the
+ * saturation vapour pressure at the given temperature and the relative
+ * humidity. The dew point is the temperature at which the partial pressure
+ * saturates. It is found by interpolating the same table inversely. The
+ * absolute humidity follows from the ideal gas law of the water vapour.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "humidity.h"
+
+#include <avr/pgmspace.h>
+#include <stdint.h>
+
+/** \brief The temperature difference of two table entries in 0.1 degree */
+#define HUMIDITY_STEP (25)
+
+/** \brief The number of table entries */
+#define HUMIDITY_TABLE_SIZE \
+	((HUMIDITY_MAX_TEMPERATURE - HUMIDITY_MIN_TEMPERATURE) / HUMIDITY_STEP + 1)
+
+/** \brief The offset of the Kelvin scale in 0.1 degree Celsius */
+#define HUMIDITY_ZERO_KELVIN (2732)
+
+/**
+ * \brief The reciprocal specific gas constant of water vapour
+ * \details The value is given by 1000000 / 461.5 J/(kg K). It converts the
+ * quotient of a partial pressure in 0.1 Pa and a temperature in 0.1 K to a
+ * density in 0.001 g/m^3.
+ */
+#define HUMIDITY_GAS_FACTOR (2167UL)
+
+/**
+ * \brief The saturation vapour pressure over water in 0.1 Pa
+ * \details Entry n belongs to the temperature \ref HUMIDITY_MIN_TEMPERATURE +
+ * n * \ref HUMIDITY_STEP. The values are given by the Magnus formula
+ * 611.2 Pa * exp(17.62 * t / (243.12 + t)).
+ */
+static const uint32_t humidity_saturation[HUMIDITY_TABLE_SIZE] PROGMEM = {
+		190UL, 246UL, 316UL, 403UL, 512UL, 646UL,
+		811UL, 1013UL, 1260UL, 1558UL, 1919UL, 2352UL,
+		2870UL, 3488UL, 4222UL, 5090UL, 6112UL, 7313UL,
+		8717UL, 10356UL, 12260UL, 14467UL, 17017UL, 19953UL,
+		23326UL, 27189UL, 31601UL, 36627UL, 42337UL, 48810UL,
+		56128UL, 64384UL, 73675UL, 84107UL, 95797UL, 108868UL,
+		123452UL, 139692UL, 157742UL, 177764UL, 199933UL, 224435UL,
+		251467UL, 281240UL, 313977UL, 349913UL, 389299UL, 432398UL,
+		479489UL };
+
+/** \brief Reads the table entry at the given index */
+#define HUMIDITY_SATURATION(index) \
+	((uint32_t) pgm_read_dword(&humidity_saturation[(index)]))
+
+status_t humidity_compute(int16_t temperature, int16_t relHumidity,
+		int16_t *dewPoint, int16_t *absHumidity) {
+	uint8_t index;
+	uint8_t offset;
+	uint32_t lower, upper, pressure;
+
+	if (temperature < HUMIDITY_MIN_TEMPERATURE
+			|| temperature > HUMIDITY_MAX_TEMPERATURE || relHumidity <= 0) {
+		return err_indexOutOfBounds;
+	}
+	if (relHumidity > 1000) {
+		relHumidity = 1000;
+	}
+
+	// Interpolate the saturation vapour pressure
+	index = (temperature - HUMIDITY_MIN_TEMPERATURE) / HUMIDITY_STEP;
+	if (index > HUMIDITY_TABLE_SIZE - 2) {
+		index = HUMIDITY_TABLE_SIZE - 2;
+	}
+	offset = temperature - HUMIDITY_MIN_TEMPERATURE - index * HUMIDITY_STEP;
+	lower = HUMIDITY_SATURATION(index);
+	upper = HUMIDITY_SATURATION(index + 1);
+	pressure = lower + ((upper - lower) * offset + HUMIDITY_STEP / 2)
+			/ HUMIDITY_STEP;
+
+	// The partial pressure of the water vapour
+	pressure = (pressure * (uint16_t) relHumidity + 500) / 1000;
+
+	*absHumidity = (pressure * HUMIDITY_GAS_FACTOR
+			+ 5UL * (temperature + HUMIDITY_ZERO_KELVIN))
+			/ (10UL * (temperature + HUMIDITY_ZERO_KELVIN));
+
+	// The dew point doesn't exceed the temperature
+	lower = HUMIDITY_SATURATION(index);
+	while (index > 0 && lower > pressure) {
+		index--;
+		lower = HUMIDITY_SATURATION(index);
+	}
+	if (lower > pressure) {
+		*dewPoint = HUMIDITY_MIN_TEMPERATURE;
+	} else {
+		upper = HUMIDITY_SATURATION(index + 1) - lower;
+		*dewPoint = HUMIDITY_MIN_TEMPERATURE + index * HUMIDITY_STEP
+				+ (int16_t) (((pressure - lower) * HUMIDITY_STEP + upper / 2)
+						/ upper);
+	}
+
+	return success;
+}
@@ -0,0 +1,56 @@
+/**
+ * \file humidity.h
+ * \brief Derives the dew point and the absolute humidity from a reading
+ * \details The module computes both values in fixed point arithmetic. The
+ * saturation vapour pressure over water is taken from a table which is
+ * interpolated linearly. Within the supported temperature range, the dew point
+ * deviates by less than 0.15 degree Celsius and the absolute humidity by less
+ * than 0.5 percent or 0.03 g/m^3 from the exact Magnus formula.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef HUMIDITY_H_
+#define HUMIDITY_H_
+
+#include "error.h"
+
+#include <stdint.h>
+
+/** \brief The lowest supported temperature in 0.1 degree Celsius */
+#define HUMIDITY_MIN_TEMPERATURE (-400)
+/** \brief The highest supported temperature in 0.1 degree Celsius */
+#define HUMIDITY_MAX_TEMPERATURE (800)
+
+/**
+ * \brief Computes the dew point and the absolute humidity
+ * \details A relative humidity above 100 percent is treated as saturation. A
+ * dew point below \ref HUMIDITY_MIN_TEMPERATURE is reported as
+ * \ref HUMIDITY_MIN_TEMPERATURE.
+ * \param temperature The temperature in 0.1 degree Celsius
+ * \param relHumidity The relative humidity in 0.1 percent
+ * \param dewPoint Receives the dew point in 0.1 degree Celsius
+ * \param absHumidity Receives the absolute humidity in 0.01 g/m^3
+ * \return The status of the operation. err_indexOutOfBounds indicates that
+ * the temperature isn't supported or that the relative humidity isn't
+ * positive. In this case, the results are left untouched.
+ */
+status_t humidity_compute(int16_t temperature, int16_t relHumidity,
+		int16_t *dewPoint, int16_t *absHumidity);
+
+#endif /* HUMIDITY_H_ */
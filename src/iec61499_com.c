@@ -23,33 +23,262 @@
 
 #include "esp8266_receiver.h"
 
-/** \brief Flags which indicate an application specific ASN.1 type class */
-#define IEC61499_COM_CLASS_APPLICATION (0x40)
+#include <string.h>
+
+/** \brief The number of bytes of an encoded ARRAY or STRING header */
+#define IEC61499_COM_HEADER_SIZE (3)
+
+/**
+ * \brief Defines a decode and a read function of a fixed size type
+ * \details Both functions are thin wrappers around the generic
+ * \ref iec61499_com_decodeValue and \ref iec61499_com_readValue functions.
+ * \param type The IEC 61499 type name
+ * \param ctype The native C type of the value
+ */
+#define IEC61499_COM_DEFINE_ACCESSORS(type, ctype) \
+	status_t iec61499_com_decode##type(uint8_t rrbID, uint8_t size, \
+			uint8_t *nextIndex, ctype *value) { \
+		uint32_t raw; \
+		status_t err = iec61499_com_decodeValue(rrbID, size, nextIndex, \
+				IEC61499_COM_TAG_##type, &raw); \
+		if (err == success) { \
+			*value = (ctype) raw; \
+		} \
+		return err; \
+	} \
+	status_t iec61499_com_read##type(uint8_t rrbID, uint8_t offset, \
+			ctype *value) { \
+		uint32_t raw; \
+		status_t err = iec61499_com_readValue(rrbID, offset, \
+				IEC61499_COM_TAG_##type, &raw); \
+		if (err == success) { \
+			*value = (ctype) raw; \
+		} \
+		return err; \
+	}
+
+/** \brief Reinterprets the bits of a REAL value */
+typedef union {
+	float real; ///< \brief The floating point representation
+	uint32_t raw; ///< \brief The IEEE 754 bit pattern
+} iec61499_com_real_t;
+
+/**
+ * \brief Returns the number of value bytes which follow the tag
+ * \param tag The tag number of a fixed size type
+ * \return The size of the encoded value without the tag. BOOL values and
+ * unknown tags return zero.
+ */
+static uint8_t iec61499_com_valueSize(uint8_t tag) {
+	switch (tag) {
+	case IEC61499_COM_TAG_SINT:
+	case IEC61499_COM_TAG_USINT:
+		return 1;
+	case IEC61499_COM_TAG_INT:
+	case IEC61499_COM_TAG_UINT:
+		return 2;
+	case IEC61499_COM_TAG_DINT:
+	case IEC61499_COM_TAG_UDINT:
+	case IEC61499_COM_TAG_REAL:
+		return 4;
+	case IEC61499_COM_TAG_TIME:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * \brief Returns the size of the native representation of the given type
+ * \param tag The tag number of a fixed size type or IEC61499_COM_TAG_BOOL
+ * \return The number of bytes of the native element
+ */
+static uint8_t iec61499_com_nativeSize(uint8_t tag) {
+	uint8_t size = iec61499_com_valueSize(tag);
+	if (size == 0) {
+		return 1;
+	} else if (size > 4) {
+		return 4;
+	}
+	return size;
+}
+
+/**
+ * \brief Writes the value in network byte order
+ * \details Encodings which are larger than four bytes are sign extended.
+ * \param dst The destination of the first value byte
+ * \param value The value to encode
+ * \param valueSize The number of bytes to write
+ */
+static void iec61499_com_putValue(uint8_t *dst, uint32_t value,
+		uint8_t valueSize) {
+	while (valueSize > 0) {
+		valueSize--;
+		dst[valueSize] = value & 0xFF;
+		value = (uint32_t) (((int32_t) value) >> 8);
+	}
+}
 
 /**
- * \brief The ASN.1 tag number of INT without any flags
- * \details The tag numbers are defined in the informative Annex E of the IEC
- * 61499
+ * \brief Reads a value in network byte order from the receive buffer
+ * \details Encodings which are larger than four bytes are truncated.
+ * \param rrbID The round robin buffer id of the message
+ * \param offset The offset of the first value byte
+ * \param valueSize The number of bytes to read
+ * \return The value in native byte order. Signed values are sign extended.
  */
-#define IEC61499_COM_TAG_INT (3)
+static uint32_t iec61499_com_getValue(uint8_t rrbID, uint8_t offset,
+		uint8_t valueSize) {
+	uint32_t value;
+
+	value = (int8_t) esp8266_receiver_getByte(rrbID, offset);
+	while (--valueSize > 0) {
+		offset++;
+		value = (value << 8) | esp8266_receiver_getByte(rrbID, offset);
+	}
+	return value;
+}
+
 /**
- * \brief The ASN.1 tag number of USINT without any flags
- * \details The tag numbers are defined in the informative Annex E of the IEC
- * 61499
+ * \brief Loads a native element
+ * \param element A pointer to the native element
+ * \param nativeSize The size of the native element in bytes
+ * \return The sign extended element
  */
-#define IEC61499_COM_TAG_USINT (6)
+static uint32_t iec61499_com_loadNative(const void *element,
+		uint8_t nativeSize) {
+	switch (nativeSize) {
+	case 1:
+		return (uint32_t) (int32_t) *(const int8_t*) element;
+	case 2:
+		return (uint32_t) (int32_t) *(const int16_t*) element;
+	default:
+		return *(const uint32_t*) element;
+	}
+}
+
 /**
- * \brief The ASN.1 tag number of a BOOL TRUE value without any flags
- * \details The tag numbers are defined in the informative Annex E of the IEC
- * 61499
+ * \brief Stores a native element
+ * \param element A pointer to the native element
+ * \param nativeSize The size of the native element in bytes
+ * \param value The value to store
  */
-#define IEC61499_COM_TAG_TRUE (1)
+static void iec61499_com_storeNative(void *element, uint8_t nativeSize,
+		uint32_t value) {
+	switch (nativeSize) {
+	case 1:
+		*(uint8_t*) element = (uint8_t) value;
+		break;
+	case 2:
+		*(uint16_t*) element = (uint16_t) value;
+		break;
+	default:
+		*(uint32_t*) element = value;
+		break;
+	}
+}
+
+/**
+ * \brief Encodes a value of a fixed size type
+ * \see iec61499_com_encodeINT
+ * \param tag The tag number of the type
+ */
+static void iec61499_com_encodeValue(uint8_t *buffer, uint8_t size,
+		uint8_t *nextIndex, uint8_t tag, uint32_t value) {
+	uint8_t valueSize = iec61499_com_valueSize(tag);
+
+	if ((*nextIndex) + 1 + valueSize <= size) {
+		buffer[*nextIndex] = IEC61499_COM_CLASS_APPLICATION | tag;
+		iec61499_com_putValue(&buffer[*nextIndex + 1], value, valueSize);
+	}
+
+	*nextIndex += 1 + valueSize;
+}
+
 /**
- * \brief The ASN.1 tag number of a BOOL FALSE value without any flags
- * \details The tag numbers are defined in the informative Annex E of the IEC
- * 61499
+ * \brief Reads a value of a fixed size type without checking the size
+ * \see iec61499_com_readUSINT
+ * \param tag The expected tag number
  */
-#define IEC61499_COM_TAG_FALSE (0)
+static status_t iec61499_com_readValue(uint8_t rrbID, uint8_t offset,
+		uint8_t tag, uint32_t *value) {
+
+	if (esp8266_receiver_getByte(rrbID, offset)
+			!= (tag | IEC61499_COM_CLASS_APPLICATION)) {
+		return err_invalidMagicNumber;
+	}
+
+	*value = iec61499_com_getValue(rrbID, offset + 1,
+			iec61499_com_valueSize(tag));
+	return success;
+}
+
+/**
+ * \brief Decodes a value of a fixed size type
+ * \see iec61499_com_decodeUSINT
+ * \param tag The expected tag number
+ */
+static status_t iec61499_com_decodeValue(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, uint8_t tag, uint32_t *value) {
+	uint8_t encSize = 1 + iec61499_com_valueSize(tag);
+	status_t err;
+
+	if (*nextIndex + encSize > size) {
+		return err_indexOutOfBounds;
+	}
+
+	err = iec61499_com_readValue(rrbID, *nextIndex, tag, value);
+	if (err == success) {
+		*nextIndex += encSize;
+	}
+	return err;
+}
+
+/**
+ * \brief Writes the header of a STRING or an ARRAY
+ * \details It is assumed that the buffer holds at least
+ * IEC61499_COM_HEADER_SIZE bytes.
+ * \param dst The destination of the header
+ * \param tagByte The complete tag byte including any class flags
+ * \param length The number of characters or elements
+ */
+static void iec61499_com_putHeader(uint8_t *dst, uint8_t tagByte,
+		uint8_t length) {
+	dst[0] = tagByte;
+	dst[1] = 0;
+	dst[2] = length;
+}
+
+/**
+ * \brief Reads the header of a STRING or an ARRAY
+ * \details The size of the buffer is checked.
+ * \param rrbID The round robin buffer id of the message
+ * \param size The size of the message
+ * \param index The index of the header
+ * \param tagByte The expected tag byte including any class flags
+ * \param capacity The maximum length which is accepted
+ * \param length The destination of the decoded length
+ * \return The status of the operation.
+ */
+static status_t iec61499_com_getHeader(uint8_t rrbID, uint8_t size,
+		uint8_t index, uint8_t tagByte, uint8_t capacity, uint8_t *length) {
+
+	if (index + IEC61499_COM_HEADER_SIZE > size) {
+		return err_indexOutOfBounds;
+	}
+
+	if (esp8266_receiver_getByte(rrbID, index) != tagByte) {
+		return err_invalidMagicNumber;
+	}
+
+	if (esp8266_receiver_getByte(rrbID, index + 1) != 0
+			|| esp8266_receiver_getByte(rrbID, index + 2) > capacity) {
+		return err_sizeOutOfBounds;
+	}
+
+	*length = esp8266_receiver_getByte(rrbID, index + 2);
+	return success;
+}
 
 void iec61499_com_encodeINT(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
 		int16_t value) {
@@ -64,37 +293,160 @@ void iec61499_com_encodeINT(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
 
 }
 
-status_t iec61499_com_decodeUSINT(uint8_t rrbID, uint8_t size,
-		uint8_t *nextIndex, uint8_t *value) {
+void iec61499_com_encodeBOOL(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
+		uint8_t value) {
 
-	if (*nextIndex + IEC61499_COM_USINT_ENC_SIZE > size) {
-		return err_indexOutOfBounds;
+	if ((*nextIndex) + IEC61499_COM_BOOL_ENC_SIZE <= size) {
+		buffer[*nextIndex] = IEC61499_COM_CLASS_APPLICATION
+				| (value ? IEC61499_COM_TAG_TRUE : IEC61499_COM_TAG_FALSE);
 	}
 
-	if (esp8266_receiver_getByte(rrbID, *nextIndex)
-			!= (IEC61499_COM_TAG_USINT | IEC61499_COM_CLASS_APPLICATION)) {
-		return err_invalidMagicNumber;
+	*nextIndex += IEC61499_COM_BOOL_ENC_SIZE;
+}
+
+void iec61499_com_encodeSINT(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
+		int8_t value) {
+	iec61499_com_encodeValue(buffer, size, nextIndex, IEC61499_COM_TAG_SINT,
+			(uint32_t) value);
+}
+
+void iec61499_com_encodeDINT(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
+		int32_t value) {
+	iec61499_com_encodeValue(buffer, size, nextIndex, IEC61499_COM_TAG_DINT,
+			(uint32_t) value);
+}
+
+void iec61499_com_encodeUSINT(uint8_t *buffer, uint8_t size,
+		uint8_t *nextIndex, uint8_t value) {
+	iec61499_com_encodeValue(buffer, size, nextIndex, IEC61499_COM_TAG_USINT,
+			value);
+}
+
+void iec61499_com_encodeUINT(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
+		uint16_t value) {
+	iec61499_com_encodeValue(buffer, size, nextIndex, IEC61499_COM_TAG_UINT,
+			value);
+}
+
+void iec61499_com_encodeUDINT(uint8_t *buffer, uint8_t size,
+		uint8_t *nextIndex, uint32_t value) {
+	iec61499_com_encodeValue(buffer, size, nextIndex, IEC61499_COM_TAG_UDINT,
+			value);
+}
+
+void iec61499_com_encodeREAL(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
+		float value) {
+	iec61499_com_real_t conv;
+	conv.real = value;
+	iec61499_com_encodeValue(buffer, size, nextIndex, IEC61499_COM_TAG_REAL,
+			conv.raw);
+}
+
+void iec61499_com_encodeTIME(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
+		int32_t value) {
+	iec61499_com_encodeValue(buffer, size, nextIndex, IEC61499_COM_TAG_TIME,
+			(uint32_t) value);
+}
+
+void iec61499_com_encodeSTRING(uint8_t *buffer, uint8_t size,
+		uint8_t *nextIndex, const char *value, uint8_t length) {
+
+	if ((*nextIndex) + IEC61499_COM_STRING_ENC_SIZE(length) <= size) {
+		iec61499_com_putHeader(&buffer[*nextIndex],
+				IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_TAG_STRING, length);
+		memcpy(&buffer[*nextIndex + IEC61499_COM_HEADER_SIZE], value, length);
 	}
 
-	*value = esp8266_receiver_getByte(rrbID, *nextIndex + 1);
-	*nextIndex += IEC61499_COM_USINT_ENC_SIZE;
-	return success;
+	*nextIndex += IEC61499_COM_STRING_ENC_SIZE(length);
+}
+
+void iec61499_com_encodeARRAY(uint8_t *buffer, uint8_t size,
+		uint8_t *nextIndex, uint8_t tag, const void *elements, uint8_t count) {
+	uint8_t valueSize = iec61499_com_valueSize(tag);
+	uint8_t nativeSize = iec61499_com_nativeSize(tag);
+	uint16_t encSize = IEC61499_COM_HEADER_SIZE;
+	const uint8_t *element = elements;
+	uint8_t *dst;
+	uint8_t i;
+
+	if (count > 0) {
+		// BOOL elements are encoded as tags. Other types send their tag once.
+		encSize += (valueSize == 0 ? count : 1 + valueSize * (uint16_t) count);
+	}
+
+	if ((*nextIndex) + encSize <= size) {
+		dst = &buffer[*nextIndex];
+		iec61499_com_putHeader(dst,
+				IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_CLASS_CONSTRUCTED
+						| IEC61499_COM_TAG_ARRAY, count);
+		dst += IEC61499_COM_HEADER_SIZE;
+
+		if (count > 0 && valueSize > 0) {
+			*dst++ = IEC61499_COM_CLASS_APPLICATION | tag;
+		}
+
+		for (i = 0; i < count; i++) {
+			if (valueSize == 0) {
+				*dst++ = IEC61499_COM_CLASS_APPLICATION
+						| (*element ? IEC61499_COM_TAG_TRUE : IEC61499_COM_TAG_FALSE);
+			} else {
+				iec61499_com_putValue(dst,
+						iec61499_com_loadNative(element, nativeSize), valueSize);
+				dst += valueSize;
+			}
+			element += nativeSize;
+		}
+	}
+
+	*nextIndex += encSize;
+}
+
+void iec61499_com_updateINT(uint8_t *encoded, int16_t value) {
+	encoded[1] = (value >> 8) & 0xFF;
+	encoded[2] = value & 0xFF;
+}
+
+uint8_t iec61499_com_projectFrame(uint8_t *dst, const void *frame,
+		const uint8_t *fieldSizes, uint8_t fieldCount, uint32_t mask) {
+	const uint8_t *src = frame;
+	uint8_t size = 0;
+	uint8_t i;
+
+	for (i = 0; i < fieldCount; i++) {
+		if (mask & 0x01) {
+			memcpy(&dst[size], src, fieldSizes[i]);
+			size += fieldSizes[i];
+		}
+		src += fieldSizes[i];
+		mask >>= 1;
+	}
+
+	return size;
 }
 
 status_t iec61499_com_decodeBOOL(uint8_t rrbID, uint8_t size,
 		uint8_t *nextIndex, uint8_t *value) {
+	status_t err;
 
 	if (*nextIndex + IEC61499_COM_BOOL_ENC_SIZE > size) {
 		return err_indexOutOfBounds;
 	}
 
-	if (esp8266_receiver_getByte(rrbID, *nextIndex)
-			== (IEC61499_COM_TAG_TRUE | IEC61499_COM_CLASS_APPLICATION)) {
+	err = iec61499_com_readBOOL(rrbID, *nextIndex, value);
+	if (err == success) {
+		*nextIndex += IEC61499_COM_BOOL_ENC_SIZE;
+	}
+	return err;
+}
+
+status_t iec61499_com_readBOOL(uint8_t rrbID, uint8_t offset, uint8_t *value) {
+	uint8_t tag = esp8266_receiver_getByte(rrbID, offset);
+
+	if (tag == (IEC61499_COM_TAG_TRUE | IEC61499_COM_CLASS_APPLICATION)) {
 
 		*value = (uint8_t)(-1);
 
-	}else if(esp8266_receiver_getByte(rrbID, *nextIndex)
-			== (IEC61499_COM_TAG_FALSE | IEC61499_COM_CLASS_APPLICATION)){
+	}else if(tag == (IEC61499_COM_TAG_FALSE | IEC61499_COM_CLASS_APPLICATION)){
 
 		*value = 0;
 
@@ -102,6 +454,131 @@ status_t iec61499_com_decodeBOOL(uint8_t rrbID, uint8_t size,
 		return err_invalidMagicNumber;
 	}
 
-	*nextIndex += IEC61499_COM_BOOL_ENC_SIZE;
+	return success;
+}
+
+IEC61499_COM_DEFINE_ACCESSORS(SINT, int8_t)
+IEC61499_COM_DEFINE_ACCESSORS(INT, int16_t)
+IEC61499_COM_DEFINE_ACCESSORS(DINT, int32_t)
+IEC61499_COM_DEFINE_ACCESSORS(USINT, uint8_t)
+IEC61499_COM_DEFINE_ACCESSORS(UINT, uint16_t)
+IEC61499_COM_DEFINE_ACCESSORS(UDINT, uint32_t)
+IEC61499_COM_DEFINE_ACCESSORS(TIME, int32_t)
+
+status_t iec61499_com_decodeREAL(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, float *value) {
+	iec61499_com_real_t conv;
+	status_t err = iec61499_com_decodeValue(rrbID, size, nextIndex,
+			IEC61499_COM_TAG_REAL, &conv.raw);
+	if (err == success) {
+		*value = conv.real;
+	}
+	return err;
+}
+
+status_t iec61499_com_readREAL(uint8_t rrbID, uint8_t offset, float *value) {
+	iec61499_com_real_t conv;
+	status_t err = iec61499_com_readValue(rrbID, offset, IEC61499_COM_TAG_REAL,
+			&conv.raw);
+	if (err == success) {
+		*value = conv.real;
+	}
+	return err;
+}
+
+status_t iec61499_com_decodeSTRING(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, char *value, uint8_t capacity, uint8_t *length) {
+	status_t err;
+	uint8_t len, i;
+
+	err = iec61499_com_getHeader(rrbID, size, *nextIndex,
+			IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_TAG_STRING, capacity,
+			&len);
+	if (err != success) {
+		return err;
+	}
+
+	if (*nextIndex + IEC61499_COM_STRING_ENC_SIZE(len) > size) {
+		return err_indexOutOfBounds;
+	}
+
+	for (i = 0; i < len; i++) {
+		value[i] = esp8266_receiver_getByte(rrbID,
+				*nextIndex + IEC61499_COM_HEADER_SIZE + i);
+	}
+
+	*length = len;
+	*nextIndex += IEC61499_COM_STRING_ENC_SIZE(len);
+	return success;
+}
+
+status_t iec61499_com_decodeARRAYHeader(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, uint8_t tag, uint8_t capacity, uint8_t *count) {
+	uint8_t valueSize = iec61499_com_valueSize(tag);
+	uint16_t index = *nextIndex + IEC61499_COM_HEADER_SIZE;
+	uint16_t encSize;
+	uint8_t cnt;
+	status_t err;
+
+	err = iec61499_com_getHeader(rrbID, size, *nextIndex,
+			IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_CLASS_CONSTRUCTED
+					| IEC61499_COM_TAG_ARRAY, capacity, &cnt);
+	if (err != success) {
+		return err;
+	}
+
+	if (cnt > 0) {
+		encSize = (valueSize == 0 ? cnt : 1 + valueSize * (uint16_t) cnt);
+		if (index + encSize > size) {
+			return err_indexOutOfBounds;
+		}
+
+		if (valueSize > 0) {
+			if (esp8266_receiver_getByte(rrbID, index)
+					!= (tag | IEC61499_COM_CLASS_APPLICATION)) {
+				return err_invalidMagicNumber;
+			}
+			index++;
+		}
+	}
+
+	*count = cnt;
+	*nextIndex = index;
+	return success;
+}
+
+status_t iec61499_com_decodeARRAY(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, uint8_t tag, void *elements, uint8_t capacity,
+		uint8_t *count) {
+	uint8_t valueSize = iec61499_com_valueSize(tag);
+	uint8_t nativeSize = iec61499_com_nativeSize(tag);
+	uint8_t *element = elements;
+	uint8_t index = *nextIndex;
+	uint8_t cnt, i;
+	status_t err;
+
+	err = iec61499_com_decodeARRAYHeader(rrbID, size, &index, tag, capacity,
+			&cnt);
+	if (err != success) {
+		return err;
+	}
+
+	for (i = 0; i < cnt; i++) {
+		if (valueSize == 0) {
+			err = iec61499_com_readBOOL(rrbID, index, element);
+			if (err != success) {
+				return err;
+			}
+			index++;
+		} else {
+			iec61499_com_storeNative(element, nativeSize,
+					iec61499_com_getValue(rrbID, index, valueSize));
+			index += valueSize;
+		}
+		element += nativeSize;
+	}
+
+	*count = cnt;
+	*nextIndex = index;
 	return success;
 }
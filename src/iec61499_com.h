@@ -28,14 +28,120 @@
 #include "error.h"
 
 #include <stdint.h>
+#include <stddef.h>
 
+/** \brief Flags which indicate an application specific ASN.1 type class */
+#define IEC61499_COM_CLASS_APPLICATION (0x40)
+/** \brief Flag which indicates a constructed ASN.1 type */
+#define IEC61499_COM_CLASS_CONSTRUCTED (0x20)
+
+/*
+ * The tag numbers are defined in the informative Annex E of the IEC 61499. The
+ * definitions don't include any class flags.
+ */
+/** \brief The ASN.1 tag number of a BOOL FALSE value */
+#define IEC61499_COM_TAG_FALSE (0)
+/** \brief The ASN.1 tag number of a BOOL TRUE value */
+#define IEC61499_COM_TAG_TRUE (1)
+/** \brief The ASN.1 tag number of SINT */
+#define IEC61499_COM_TAG_SINT (2)
+/** \brief The ASN.1 tag number of INT */
+#define IEC61499_COM_TAG_INT (3)
+/** \brief The ASN.1 tag number of DINT */
+#define IEC61499_COM_TAG_DINT (4)
+/** \brief The ASN.1 tag number of USINT */
+#define IEC61499_COM_TAG_USINT (6)
+/** \brief The ASN.1 tag number of UINT */
+#define IEC61499_COM_TAG_UINT (7)
+/** \brief The ASN.1 tag number of UDINT */
+#define IEC61499_COM_TAG_UDINT (8)
+/** \brief The ASN.1 tag number of REAL */
+#define IEC61499_COM_TAG_REAL (10)
+/** \brief The ASN.1 tag number of TIME */
+#define IEC61499_COM_TAG_TIME (12)
+/** \brief The ASN.1 tag number of STRING */
+#define IEC61499_COM_TAG_STRING (16)
+/**
+ * \brief The ASN.1 tag number of ARRAY
+ * \details Arrays are encoded as constructed type. The tag is followed by the
+ * 16 bit number of elements. The tag of the element type is sent once before
+ * the first element. Elements of type BOOL are sent as tags only.
+ */
+#define IEC61499_COM_TAG_ARRAY (22)
+/**
+ * \brief A pseudo tag number which denotes BOOL elements of an array
+ * \details BOOL values don't have a dedicated tag number. The pseudo tag is
+ * only used to select the element type of \ref iec61499_com_encodeARRAY and
+ * \ref iec61499_com_decodeARRAY.
+ */
+#define IEC61499_COM_TAG_BOOL IEC61499_COM_TAG_FALSE
+
+/** \brief The number of bytes which are allocated by an encoded BOOL value */
+#define IEC61499_COM_BOOL_ENC_SIZE (1)
+/** \brief The number of bytes which are allocated by an encoded SINT value */
+#define IEC61499_COM_SINT_ENC_SIZE (2)
 /** \brief The number of bytes which are allocated by an encoded INT value */
 #define IEC61499_COM_INT_ENC_SIZE (3)
+/** \brief The number of bytes which are allocated by an encoded DINT value */
+#define IEC61499_COM_DINT_ENC_SIZE (5)
 /** \brief The number of bytes which are allocated by an encoded USINT value */
 #define IEC61499_COM_USINT_ENC_SIZE (2)
-/** \brief The number of bytes which are allocated by an encoded BOOL value */
-#define IEC61499_COM_BOOL_ENC_SIZE (1)
+/** \brief The number of bytes which are allocated by an encoded UINT value */
+#define IEC61499_COM_UINT_ENC_SIZE (3)
+/** \brief The number of bytes which are allocated by an encoded UDINT value */
+#define IEC61499_COM_UDINT_ENC_SIZE (5)
+/** \brief The number of bytes which are allocated by an encoded REAL value */
+#define IEC61499_COM_REAL_ENC_SIZE (5)
+/** \brief The number of bytes which are allocated by an encoded TIME value */
+#define IEC61499_COM_TIME_ENC_SIZE (9)
+/**
+ * \brief The number of bytes which are allocated by an encoded STRING
+ * \param length The number of characters of the string
+ */
+#define IEC61499_COM_STRING_ENC_SIZE(length) (3 + (length))
+
+/** \brief The native representation of a decoded BOOL value */
+typedef uint8_t iec61499_com_BOOL_t;
+/** \brief The native representation of a decoded SINT value */
+typedef int8_t iec61499_com_SINT_t;
+/** \brief The native representation of a decoded INT value */
+typedef int16_t iec61499_com_INT_t;
+/** \brief The native representation of a decoded DINT value */
+typedef int32_t iec61499_com_DINT_t;
+/** \brief The native representation of a decoded USINT value */
+typedef uint8_t iec61499_com_USINT_t;
+/** \brief The native representation of a decoded UINT value */
+typedef uint16_t iec61499_com_UINT_t;
+/** \brief The native representation of a decoded UDINT value */
+typedef uint32_t iec61499_com_UDINT_t;
+/** \brief The native representation of a decoded REAL value */
+typedef float iec61499_com_REAL_t;
+/**
+ * \brief The native representation of a decoded TIME value
+ * \details TIME is transmitted as 64 bit integer. Only the lower 32 bits are
+ * handled by the module. Encoded values are sign extended and decoded values
+ * are truncated. The unit is defined by the controller.
+ */
+typedef int32_t iec61499_com_TIME_t;
 
+/** \brief The memory layout of an encoded BOOL value */
+typedef uint8_t iec61499_com_BOOL_enc_t[IEC61499_COM_BOOL_ENC_SIZE];
+/** \brief The memory layout of an encoded SINT value */
+typedef uint8_t iec61499_com_SINT_enc_t[IEC61499_COM_SINT_ENC_SIZE];
+/** \brief The memory layout of an encoded INT value */
+typedef uint8_t iec61499_com_INT_enc_t[IEC61499_COM_INT_ENC_SIZE];
+/** \brief The memory layout of an encoded DINT value */
+typedef uint8_t iec61499_com_DINT_enc_t[IEC61499_COM_DINT_ENC_SIZE];
+/** \brief The memory layout of an encoded USINT value */
+typedef uint8_t iec61499_com_USINT_enc_t[IEC61499_COM_USINT_ENC_SIZE];
+/** \brief The memory layout of an encoded UINT value */
+typedef uint8_t iec61499_com_UINT_enc_t[IEC61499_COM_UINT_ENC_SIZE];
+/** \brief The memory layout of an encoded UDINT value */
+typedef uint8_t iec61499_com_UDINT_enc_t[IEC61499_COM_UDINT_ENC_SIZE];
+/** \brief The memory layout of an encoded REAL value */
+typedef uint8_t iec61499_com_REAL_enc_t[IEC61499_COM_REAL_ENC_SIZE];
+/** \brief The memory layout of an encoded TIME value */
+typedef uint8_t iec61499_com_TIME_enc_t[IEC61499_COM_TIME_ENC_SIZE];
 
 /**
  * \brief Adds an INT value to the message buffer.
@@ -53,6 +159,177 @@
 void iec61499_com_encodeINT(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
 		int16_t value);
 
+/**
+ * \brief Adds a BOOL value to the message buffer.
+ * \see iec61499_com_encodeINT
+ */
+void iec61499_com_encodeBOOL(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
+		uint8_t value);
+/**
+ * \brief Adds a SINT value to the message buffer.
+ * \see iec61499_com_encodeINT
+ */
+void iec61499_com_encodeSINT(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
+		int8_t value);
+/**
+ * \brief Adds a DINT value to the message buffer.
+ * \see iec61499_com_encodeINT
+ */
+void iec61499_com_encodeDINT(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
+		int32_t value);
+/**
+ * \brief Adds a USINT value to the message buffer.
+ * \see iec61499_com_encodeINT
+ */
+void iec61499_com_encodeUSINT(uint8_t *buffer, uint8_t size,
+		uint8_t *nextIndex, uint8_t value);
+/**
+ * \brief Adds a UINT value to the message buffer.
+ * \see iec61499_com_encodeINT
+ */
+void iec61499_com_encodeUINT(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
+		uint16_t value);
+/**
+ * \brief Adds a UDINT value to the message buffer.
+ * \see iec61499_com_encodeINT
+ */
+void iec61499_com_encodeUDINT(uint8_t *buffer, uint8_t size,
+		uint8_t *nextIndex, uint32_t value);
+/**
+ * \brief Adds a REAL value to the message buffer.
+ * \see iec61499_com_encodeINT
+ */
+void iec61499_com_encodeREAL(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
+		float value);
+/**
+ * \brief Adds a TIME value to the message buffer.
+ * \see iec61499_com_encodeINT
+ * \see iec61499_com_TIME_t
+ */
+void iec61499_com_encodeTIME(uint8_t *buffer, uint8_t size, uint8_t *nextIndex,
+		int32_t value);
+
+/**
+ * \brief Adds a STRING to the message buffer.
+ * \details The string is copied without any terminating character. See
+ * \ref iec61499_com_encodeINT for the handling of the buffer size.
+ * \param buffer A pointer to the first byte of the destination message buffer.
+ * \param size The total capacity of the message buffer in bytes
+ * \param nextIndex A pointer to a memory location which holds the next index in
+ * the buffer which should be populated.
+ * \param value A pointer to the first character of the string. It has to hold
+ * at least length characters.
+ * \param length The number of characters to encode
+ */
+void iec61499_com_encodeSTRING(uint8_t *buffer, uint8_t size,
+		uint8_t *nextIndex, const char *value, uint8_t length);
+
+/**
+ * \brief Adds an ARRAY to the message buffer.
+ * \details The elements are given in their native representation (e.g.
+ * iec61499_com_UINT_t for UINT elements). See \ref iec61499_com_encodeINT for
+ * the handling of the buffer size.
+ * \param buffer A pointer to the first byte of the destination message buffer.
+ * \param size The total capacity of the message buffer in bytes
+ * \param nextIndex A pointer to a memory location which holds the next index in
+ * the buffer which should be populated.
+ * \param tag The tag number of the element type. Every fixed size type and
+ * \ref IEC61499_COM_TAG_BOOL is supported.
+ * \param elements A pointer to the first native element
+ * \param count The number of elements to encode
+ */
+void iec61499_com_encodeARRAY(uint8_t *buffer, uint8_t size,
+		uint8_t *nextIndex, uint8_t tag, const void *elements, uint8_t count);
+
+/**
+ * \brief Expands to the initializer list of an encoded INT value
+ * \details The list contains IEC61499_COM_INT_ENC_SIZE bytes and may be used
+ * to statically allocate a message template. The tag is fixed at compile time
+ * and the value is set to zero. The value may be changed afterwards by calling
+ * \ref iec61499_com_updateINT. Similar macros are defined for every fixed size
+ * type.
+ */
+#define IEC61499_COM_INT_TEMPLATE \
+	(IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_TAG_INT), 0x00, 0x00
+/** \brief Expands to the initializer list of an encoded BOOL value */
+#define IEC61499_COM_BOOL_TEMPLATE \
+	(IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_TAG_FALSE)
+/** \brief Expands to the initializer list of an encoded SINT value */
+#define IEC61499_COM_SINT_TEMPLATE \
+	(IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_TAG_SINT), 0x00
+/** \brief Expands to the initializer list of an encoded DINT value */
+#define IEC61499_COM_DINT_TEMPLATE \
+	(IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_TAG_DINT), 0x00, 0x00, \
+	0x00, 0x00
+/** \brief Expands to the initializer list of an encoded USINT value */
+#define IEC61499_COM_USINT_TEMPLATE \
+	(IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_TAG_USINT), 0x00
+/** \brief Expands to the initializer list of an encoded UINT value */
+#define IEC61499_COM_UINT_TEMPLATE \
+	(IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_TAG_UINT), 0x00, 0x00
+/** \brief Expands to the initializer list of an encoded UDINT value */
+#define IEC61499_COM_UDINT_TEMPLATE \
+	(IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_TAG_UDINT), 0x00, 0x00, \
+	0x00, 0x00
+/** \brief Expands to the initializer list of an encoded REAL value */
+#define IEC61499_COM_REAL_TEMPLATE \
+	(IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_TAG_REAL), 0x00, 0x00, \
+	0x00, 0x00
+/** \brief Expands to the initializer list of an encoded TIME value */
+#define IEC61499_COM_TIME_TEMPLATE \
+	(IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_TAG_TIME), 0x00, 0x00, \
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+
+/**
+ * \brief Gives the encoded size of an ARRAY with a fixed number of elements
+ * \details The array consists of the header, the element tag and the values of
+ * each element. Every fixed size type except BOOL is supported.
+ * \param type The IEC 61499 type name of the elements (e.g. UDINT)
+ * \param count The number of elements
+ */
+#define IEC61499_COM_ARRAY_ENC_SIZE(type, count) \
+	(3 + 1 + (count) * (IEC61499_COM_##type##_ENC_SIZE - 1))
+
+/**
+ * \brief Expands to the initializer list of an ARRAY with a fixed number of
+ * elements
+ * \details The list holds the header and the element tag only. The remaining
+ * values are zero initialized.
+ * \param type The IEC 61499 type name of the elements (e.g. UDINT)
+ * \param count The number of elements
+ */
+#define IEC61499_COM_ARRAY_TEMPLATE(type, count) \
+	(IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_CLASS_CONSTRUCTED \
+			| IEC61499_COM_TAG_ARRAY), 0x00, (count), \
+	(IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_TAG_##type)
+
+/**
+ * \brief Declares a frame field type which holds a fixed number of elements
+ * \details The macro declares the encoded and the native type of the field.
+ * Additionally, the template macro <code>IEC61499_COM_name_TEMPLATE</code>
+ * has to be defined by \ref IEC61499_COM_ARRAY_TEMPLATE. Afterwards, the name
+ * may be used as a field type of a frame layout. The field is encoded by
+ * \ref iec61499_com_encodeARRAY.
+ * \param name The name of the field type
+ * \param type The IEC 61499 type name of the elements (e.g. UDINT)
+ * \param count The number of elements
+ */
+#define IEC61499_COM_DECLARE_ARRAY(name, type, count) \
+	typedef uint8_t iec61499_com_##name##_enc_t[ \
+		IEC61499_COM_ARRAY_ENC_SIZE(type, count)]; \
+	typedef iec61499_com_##type##_t iec61499_com_##name##_t[count];
+
+/**
+ * \brief Replaces the value of a previously encoded INT.
+ * \details In contrast to \ref iec61499_com_encodeINT, the tag byte is not
+ * written and no bounds are checked. The function is intended to patch message
+ * templates which were initialized by \ref IEC61499_COM_INT_TEMPLATE.
+ * \param encoded A pointer to the first byte (the tag) of the encoded INT. It
+ * is assumed that at least IEC61499_COM_INT_ENC_SIZE bytes are accessible.
+ * \param value The new value which should be encoded.
+ */
+void iec61499_com_updateINT(uint8_t *encoded, int16_t value);
+
 /**
  * \brief Executes the function fkt if the error variable is in state success.
  * \details The macro is intended to chain several decoding commands without
@@ -109,4 +386,238 @@ status_t iec61499_com_decodeUSINT(uint8_t rrbID, uint8_t size,
 status_t iec61499_com_decodeBOOL(uint8_t rrbID, uint8_t size,
 		uint8_t *nextIndex, uint8_t *value);
 
+/**
+ * \brief Tries to decode the next SINT value in the data buffer.
+ * \see iec61499_com_decodeUSINT
+ */
+status_t iec61499_com_decodeSINT(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, int8_t *value);
+/**
+ * \brief Tries to decode the next INT value in the data buffer.
+ * \see iec61499_com_decodeUSINT
+ */
+status_t iec61499_com_decodeINT(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, int16_t *value);
+/**
+ * \brief Tries to decode the next DINT value in the data buffer.
+ * \see iec61499_com_decodeUSINT
+ */
+status_t iec61499_com_decodeDINT(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, int32_t *value);
+/**
+ * \brief Tries to decode the next UINT value in the data buffer.
+ * \see iec61499_com_decodeUSINT
+ */
+status_t iec61499_com_decodeUINT(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, uint16_t *value);
+/**
+ * \brief Tries to decode the next UDINT value in the data buffer.
+ * \see iec61499_com_decodeUSINT
+ */
+status_t iec61499_com_decodeUDINT(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, uint32_t *value);
+/**
+ * \brief Tries to decode the next REAL value in the data buffer.
+ * \see iec61499_com_decodeUSINT
+ */
+status_t iec61499_com_decodeREAL(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, float *value);
+/**
+ * \brief Tries to decode the next TIME value in the data buffer.
+ * \see iec61499_com_decodeUSINT
+ * \see iec61499_com_TIME_t
+ */
+status_t iec61499_com_decodeTIME(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, int32_t *value);
+
+/**
+ * \brief Tries to decode the next STRING in the data buffer.
+ * \details The characters are copied without appending a terminating zero. If
+ * the string doesn't fit into the destination, err_sizeOutOfBounds will be
+ * returned and the index will not be altered.
+ * \param rrbID The round robin buffer id which contains the received message.
+ * \param size The size of the buffer in bytes
+ * \param nextIndex A pointer to a location which holds the next unprocessed
+ * index. It is only increased if the string was decoded successfully.
+ * \param value A pointer to the destination which holds at least capacity
+ * characters.
+ * \param capacity The maximum number of characters to decode
+ * \param length A pointer to a location which receives the number of decoded
+ * characters.
+ * \return The status of the operation.
+ */
+status_t iec61499_com_decodeSTRING(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, char *value, uint8_t capacity, uint8_t *length);
+
+/**
+ * \brief Tries to decode the next ARRAY in the data buffer.
+ * \details The elements are stored in their native representation. If the
+ * number of elements exceeds the capacity, err_sizeOutOfBounds will be
+ * returned. If an error is returned, the index will not be altered and the
+ * content of the destination is undefined.
+ * \param rrbID The round robin buffer id which contains the received message.
+ * \param size The size of the buffer in bytes
+ * \param nextIndex A pointer to a location which holds the next unprocessed
+ * index. It is only increased if the array was decoded successfully.
+ * \param tag The tag number of the expected element type. Every fixed size
+ * type and \ref IEC61499_COM_TAG_BOOL is supported.
+ * \param elements A pointer to the destination which holds at least capacity
+ * native elements.
+ * \param capacity The maximum number of elements to decode
+ * \param count A pointer to a location which receives the number of decoded
+ * elements.
+ * \return The status of the operation.
+ */
+status_t iec61499_com_decodeARRAY(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, uint8_t tag, void *elements, uint8_t capacity,
+		uint8_t *count);
+
+/**
+ * \brief Tries to decode the header of the next ARRAY in the data buffer.
+ * \details The function checks the array tag, the element tag and the size of
+ * the whole array. The elements themselves are not decoded. Hence, the caller
+ * may process the elements while reading them from the receive buffer. Each
+ * element of a fixed size type allocates the value bytes only. Each BOOL
+ * element is given by a single tag.
+ * \param rrbID The round robin buffer id which contains the received message.
+ * \param size The size of the buffer in bytes
+ * \param nextIndex A pointer to a location which holds the next unprocessed
+ * index. On success, it is increased to the first value byte of the first
+ * element. If an error is detected, the value will not be altered.
+ * \param tag The tag number of the expected element type
+ * \param capacity The maximum number of elements which is accepted
+ * \param count A pointer to a location which receives the number of elements
+ * \return The status of the operation.
+ */
+status_t iec61499_com_decodeARRAYHeader(uint8_t rrbID, uint8_t size,
+		uint8_t *nextIndex, uint8_t tag, uint8_t capacity, uint8_t *count);
+
+/**
+ * \brief Reads the USINT value at the given offset of a received message.
+ * \details In contrast to \ref iec61499_com_decodeUSINT, the size of the
+ * message is not checked. The caller has to ensure that at least
+ * IEC61499_COM_USINT_ENC_SIZE bytes are available at the given offset. Similar
+ * functions are defined for every fixed size type.
+ * \param rrbID The round robin buffer id which contains the received message.
+ * \param offset The offset of the encoded value inside the message
+ * \param value A pointer to the destination of the parsed data. It will only be
+ * written if the tag is valid.
+ * \return The status of the operation.
+ */
+status_t iec61499_com_readUSINT(uint8_t rrbID, uint8_t offset, uint8_t *value);
+
+/**
+ * \brief Reads the BOOL value at the given offset of a received message.
+ * \details In contrast to \ref iec61499_com_decodeBOOL, the size of the
+ * message is not checked. The caller has to ensure that at least
+ * IEC61499_COM_BOOL_ENC_SIZE bytes are available at the given offset.
+ * \param rrbID The round robin buffer id which contains the received message.
+ * \param offset The offset of the encoded value inside the message
+ * \param value A pointer to the destination of the parsed data. It will only be
+ * written if the tag is valid. It will be zero iff the received boolean is
+ * false.
+ * \return The status of the operation.
+ */
+status_t iec61499_com_readBOOL(uint8_t rrbID, uint8_t offset, uint8_t *value);
+
+/** \brief Reads a SINT value. \see iec61499_com_readUSINT */
+status_t iec61499_com_readSINT(uint8_t rrbID, uint8_t offset, int8_t *value);
+/** \brief Reads an INT value. \see iec61499_com_readUSINT */
+status_t iec61499_com_readINT(uint8_t rrbID, uint8_t offset, int16_t *value);
+/** \brief Reads a DINT value. \see iec61499_com_readUSINT */
+status_t iec61499_com_readDINT(uint8_t rrbID, uint8_t offset, int32_t *value);
+/** \brief Reads a UINT value. \see iec61499_com_readUSINT */
+status_t iec61499_com_readUINT(uint8_t rrbID, uint8_t offset, uint16_t *value);
+/** \brief Reads a UDINT value. \see iec61499_com_readUSINT */
+status_t iec61499_com_readUDINT(uint8_t rrbID, uint8_t offset,
+		uint32_t *value);
+/** \brief Reads a REAL value. \see iec61499_com_readUSINT */
+status_t iec61499_com_readREAL(uint8_t rrbID, uint8_t offset, float *value);
+/** \brief Reads a TIME value. \see iec61499_com_readUSINT */
+status_t iec61499_com_readTIME(uint8_t rrbID, uint8_t offset, int32_t *value);
+
+/**
+ * \brief Declares the types of a fixed message layout
+ * \details The layout is a macro which takes another macro as argument and
+ * applies it to each field in transmission order. Each field is given by its
+ * name and its IEC 61499 type name (e.g. <code>FIELD(position, USINT)</code>).
+ * The macro declares two structures: <code>frame_enc_t</code> holds the encoded
+ * message such that offsetof and sizeof give the compile-time offsets and the
+ * total size of the message. <code>frame_t</code> holds the native values.
+ * \param frame The name prefix of the declared types
+ * \param layout The layout macro of the message
+ */
+#define IEC61499_COM_DECLARE_FRAME(frame, layout) \
+	typedef struct { layout(IEC61499_COM_FRAME_ENC_MEMBER) } frame##_enc_t; \
+	typedef struct { layout(IEC61499_COM_FRAME_VALUE_MEMBER) } frame##_t;
+
+/**
+ * \brief Expands to the initializer of a pre-encoded message
+ * \details The initializer sets every tag byte at compile time. The values are
+ * set to zero. The frame type has to be declared by
+ * \ref IEC61499_COM_DECLARE_FRAME.
+ * \param layout The layout macro of the message
+ */
+#define IEC61499_COM_FRAME_INIT(layout) { layout(IEC61499_COM_FRAME_TEMPLATE) }
+
+/**
+ * \brief Defines a function which decodes a message of the given layout
+ * \details The function is named <code>frame_decode</code> and takes the
+ * round robin buffer id, the size of the received message and a pointer to a
+ * <code>frame_t</code> structure. The size of the message is checked only once.
+ * Afterwards, each field is read at its compile-time offset. If an error is
+ * returned, the content of the destination structure is undefined.
+ * \param frame The name prefix which was passed to
+ * \ref IEC61499_COM_DECLARE_FRAME
+ * \param layout The layout macro of the message
+ */
+#define IEC61499_COM_DEFINE_DECODER(frame, layout) \
+	status_t frame##_decode(uint8_t rrbID, uint8_t size, frame##_t *value) { \
+		typedef frame##_enc_t iec61499_com_frame_t; \
+		status_t err = success; \
+		if (size < sizeof(iec61499_com_frame_t)) { \
+			return err_indexOutOfBounds; \
+		} \
+		layout(IEC61499_COM_FRAME_READ) \
+		return err; \
+	}
+
+/**
+ * \brief Expands to the initializer of an array which holds the encoded size
+ * of every field of the layout in transmission order
+ * \details The array may be passed to \ref iec61499_com_projectFrame.
+ * \param layout The layout macro of the message
+ */
+#define IEC61499_COM_FRAME_SIZES(layout) { layout(IEC61499_COM_FRAME_SIZE) }
+
+/**
+ * \brief Copies the selected fields of a pre-encoded message
+ * \details The fields are copied in transmission order without any encoding
+ * step. Hence, the destination holds a valid message which contains the
+ * selected fields only.
+ * \param dst The destination buffer. It has to be large enough to hold every
+ * selected field.
+ * \param frame A pointer to the pre-encoded message
+ * \param fieldSizes The encoded size of every field (see
+ * \ref IEC61499_COM_FRAME_SIZES)
+ * \param fieldCount The number of fields of the message
+ * \param mask The selected fields. The LSB corresponds to the first field.
+ * \return The number of bytes written to dst.
+ */
+uint8_t iec61499_com_projectFrame(uint8_t *dst, const void *frame,
+		const uint8_t *fieldSizes, uint8_t fieldCount, uint32_t mask);
+
+/** \brief Declares the encoded member of a field. Used by the frame macros. */
+#define IEC61499_COM_FRAME_ENC_MEMBER(name, type) iec61499_com_##type##_enc_t name;
+/** \brief Declares the native member of a field. Used by the frame macros. */
+#define IEC61499_COM_FRAME_VALUE_MEMBER(name, type) iec61499_com_##type##_t name;
+/** \brief Initializes the encoded field. Used by the frame macros. */
+#define IEC61499_COM_FRAME_TEMPLATE(name, type) { IEC61499_COM_##type##_TEMPLATE },
+/** \brief Gives the encoded size of a field. Used by the frame macros. */
+#define IEC61499_COM_FRAME_SIZE(name, type) sizeof(iec61499_com_##type##_enc_t),
+/** \brief Reads a single field. Used by the frame macros. */
+#define IEC61499_COM_FRAME_READ(name, type) \
+	IEC6199_COM_TRY(err, iec61499_com_read##type(rrbID, \
+			offsetof(iec61499_com_frame_t, name), &value->name));
+
 #endif /* IEC61499_COM_H_ */
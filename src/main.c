@@ -2,10 +2,18 @@
  * \file main.c
  * \brief Provides the reset vector and the main loop
  * \details The main file implements the main application logic. It queries the
- * sensors and responds to any request. If the preprocessor variable
- * USE_AM2303_CHN1 is defined, the second sensor channel will be queried.
+ * sensors which are listed in \ref sensor-config.h and responds to any
+ * request. If the preprocessor variable USE_AM2303_CHN1 is defined, the second
+ * humidity sensor channel will be queried concurrently. The DS18B20 sensors on
+ * the 1-Wire bus are queried if USE_DS18B20 is defined and the SHT3x humidity
+ * sensor on the TWI bus is queried if USE_SHT3X is defined. Defining USE_ADC
+ * enables the analog channels of \ref adc-config.h. If USE_DEW_POINT is
+ * defined, the dew point and the absolute humidity of the humidity sensors are
+ * reported as well.
  * Similarly, defining the variable USE_WS2801 will enable the LED controller
- * and defining USE_BUTTON_CNT will enable the user input module.
+ * and defining USE_BUTTON_CNT will enable the user input module. The LED
+ * animations are enabled by USE_WS2801_ANIMATION. If USE_BUTTON_LED is defined,
+ * the button counter will be shown on the LED chain immediately.
  *
  * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
  *
@@ -25,65 +33,344 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include "adc.h"
+#include "adc-config.h"
 #include "am2303.h"
+#include "deferred.h"
+#include "ds18b20.h"
 #include "esp8266_transceiver.h"
 #include "esp8266_session.h"
 #include "iec61499_com.h"
+#include "frame-config.h"
+#include "humidity.h"
+#include "sensor-config.h"
+#include "sht3x.h"
 #include "system_timer.h"
+#include "twi.h"
 #include "debug.h"
 #include "oscillator.h"
 #include "ws2801.h"
+#include "ws2801_animation.h"
 #include "button_cnt.h"
 
 #include <avr/io.h>
 #include <util/delay.h>
-#include <util/atomic.h>
 #include <avr/sfr_defs.h>
 #include <avr/interrupt.h>
 
+#if defined(USE_WS2801_ANIMATION) && !defined(USE_WS2801)
+#error "The LED animations require the LED controller USE_WS2801"
+#endif
+#if defined(USE_BUTTON_LED) \
+	&& !(defined(USE_WS2801) && defined(USE_BUTTON_CNT))
+#error "The button feedback requires USE_WS2801 and USE_BUTTON_CNT"
+#endif
+
+#ifdef USE_DS18B20
+#define MAIN_DEFERRED_DS18B20 DS18B20_DEFERRED_ITEMS
+#else
+#define MAIN_DEFERRED_DS18B20 (0)
+#endif
+#ifdef USE_SHT3X
+#define MAIN_DEFERRED_TWI TWI_DEFERRED_ITEMS
+#else
+#define MAIN_DEFERRED_TWI (0)
+#endif
+/**
+ * \brief The maximal number of deferred work items which are posted at the
+ * same time
+ * \details The drivers post from an interrupt context and can't handle a full
+ * queue. Hence, the queue must hold every item at once.
+ */
+#define MAIN_DEFERRED_ITEMS \
+	(AM2303_DEFERRED_ITEMS + MAIN_DEFERRED_DS18B20 + MAIN_DEFERRED_TWI)
+#if MAIN_DEFERRED_ITEMS > DEFERRED_QUEUE_SIZE
+#error "DEFERRED_QUEUE_SIZE is too small for the enabled drivers"
+#endif
+
 /** \brief Defines possible states of the sensor modules */
 typedef enum {
 	IDLE, ///< \brief Nothing to do
-	READ_AM2303_CHN0, ///< \brief Reads the first channel of the humidity sensor
-	READ_AM2303_CHN1, ///< \brief Reads the second channel of the humidity sensor
+	READ_SENSORS, ///< \brief Reads the selected sensor instances
 } main_sensorState_t;
 
+/** \brief The interval between two regular read cycles in milliseconds */
+#define MAIN_SENSOR_PERIOD_MS (10000)
+
+/**
+ * \brief The delay of the first retry after a failed read cycle in
+ * milliseconds
+ * \details The delay equals the minimal interval between two read cycles of
+ * the humidity sensor. It is doubled with every further attempt.
+ */
+#define MAIN_SENSOR_RETRY_MS (2000)
+
+/** \brief The maximal number of retries after a failed read cycle */
+#define MAIN_SENSOR_RETRY_COUNT (3)
+
+/**
+ * \brief The maximal duration of a read cycle in milliseconds
+ * \details Instances which didn't complete in time fail with err_timeout.
+ * The duration covers the DS18B20 conversion and bus search.
+ */
+#define MAIN_SENSOR_TIMEOUT_MS (3000)
+
 /**
  * \brief The state of the sensor module
- * \brief The variable may be written in an interrupt context. If it is not
- * IDLE, it must not be written outside the callback. Hence, the callback does
- * not need to synchronize the variable access.
+ * \details The variable is written by the sensor callback which is executed as
+ * deferred work item in the main loop. If it is not IDLE, it must not be
+ * written outside the callback and the read cycle timeout.
+ */
+static main_sensorState_t main_sensor_state;
+
+/** \brief Declares the types of the reply message */
+IEC61499_COM_DECLARE_FRAME(main_reply, FRAME_CONFIG_REPLY)
+
+/** \brief Declares the types of the default prefix of the reply message */
+IEC61499_COM_DECLARE_FRAME(main_replyDefault, FRAME_CONFIG_REPLY_DEFAULT)
+
+/**
+ * \brief The pre-encoded reply message
+ * \details The tag bytes are fixed at compile time. Only the values are
+ * patched by \ref main_updateReplyField whenever new data is available. Hence,
+ * the buffer can be sent without any encoding step. It must not be altered
+ * while the bufferBusy flag is set.
  */
-static volatile main_sensorState_t main_sensor_state;
+static main_reply_enc_t main_replyBuffer = IEC61499_COM_FRAME_INIT(
+		FRAME_CONFIG_REPLY);
+
+/** \brief The encoded size of each field of the reply message */
+static const uint8_t main_replyFieldSizes[] = IEC61499_COM_FRAME_SIZES(
+		FRAME_CONFIG_REPLY);
+
+/** \brief The number of fields of the reply message */
+#define MAIN_REPLY_FIELD_COUNT \
+	(sizeof(main_replyFieldSizes) / sizeof(main_replyFieldSizes[0]))
+
+/** \brief The field mask which selects every field of the reply message */
+#define MAIN_REPLY_ALL_FIELDS ((uint32_t) ((1ULL << MAIN_REPLY_FIELD_COUNT) - 1))
+
+/** \brief Expands to the enumerator of the field index. */
+#define MAIN_REPLY_FIELD_INDEX(name, type) MAIN_REPLY_INDEX_##name,
+
+/** \brief Enumerates the index of every reply field */
+enum {
+	FRAME_CONFIG_REPLY(MAIN_REPLY_FIELD_INDEX)
+	MAIN_REPLY_INDEX_COUNT
+};
+
+/** \brief Fails to compile if the field mask can't select every field */
+typedef char main_replyFieldCountCheck[MAIN_REPLY_INDEX_COUNT <= 32 ? 1 : -1];
+
+/** \brief Expands to one for every field */
+#define MAIN_REPLY_FIELD_ONE(name, type) + 1
+
+/** \brief The number of default fields of the reply message */
+#define MAIN_REPLY_DEFAULT_COUNT (0 FRAME_CONFIG_REPLY_DEFAULT(MAIN_REPLY_FIELD_ONE))
+
 /**
- * \brief The last temperature result of channel 0
- * \details The variable can be safely accessed outside an interrupt context if
- * the main_sensor_state is IDLE.
+ * \brief The fields which are selected unless a client selects its own fields
+ * \details The default fields are the prefix of \ref FRAME_CONFIG_REPLY. The
+ * button events, the quality fields and the derived humidity fields have to be
+ * selected explicitly. Hence, clients which expect the fixed reply layout are
+ * not affected.
  */
-static volatile uint16_t main_am2303_temperature_chn0;
+#define MAIN_REPLY_DEFAULT_FIELDS \
+	((uint32_t) ((1ULL << MAIN_REPLY_DEFAULT_COUNT) - 1))
+
 /**
- * \brief The last humidity result of channel 0
- * \details The variable can be safely accessed outside an interrupt context if
- * the main_sensor_state is IDLE.
+ * \brief The encoded size of the default fields
+ * \details The size is the offset of the first optional field, i.e. the
+ * default reply is sent from the reply buffer by length.
  */
-static volatile uint16_t main_am2303_humidity_chn0;
-#ifdef USE_AM2303_CHN1
+#define MAIN_REPLY_DEFAULT_SIZE (sizeof(main_replyDefault_enc_t))
+
+/** \brief Returns a pointer to the reply field at the given offset */
+#define MAIN_REPLY_FIELD(offset) (((uint8_t *) &main_replyBuffer) + (offset))
+
+/** \brief Describes a single sensor instance */
+typedef struct {
+	const sensor_driver_t *driver; ///< \brief The driver of the instance
+	uint8_t channel; ///< \brief The channel of the driver
+	/** \brief The offset of the first value field in the reply */
+	uint8_t valueOffset;
+	/** \brief The offset of the quality field in the reply */
+	uint8_t qualityOffset;
+} main_sensor_t;
+
+/** \brief Expands to the description of a sensor instance */
+#define MAIN_SENSOR_ENTRY(driver, channel, valueField, qualityField) \
+	{ &(driver), (channel), offsetof(main_reply_enc_t, valueField), \
+		offsetof(main_reply_enc_t, qualityField) },
+
+/** \brief Every sensor instance, see \ref sensor-config.h */
+static const main_sensor_t main_sensors[] = { SENSOR_CONFIG(MAIN_SENSOR_ENTRY) };
+
+/** \brief The number of sensor instances */
+#define MAIN_SENSOR_COUNT (sizeof(main_sensors) / sizeof(main_sensors[0]))
+
+/** \brief The mask which selects every sensor instance */
+#define MAIN_SENSOR_ALL ((uint8_t) ((1U << MAIN_SENSOR_COUNT) - 1))
+
+/**
+ * \brief The instances which didn't complete the current read cycle yet
+ * \details Bit n corresponds to instance n of \ref main_sensors. The sensor
+ * state is set to IDLE as soon as every instance completed.
+ */
+static uint8_t main_sensor_pending;
+/** \brief The instances which failed during the current read cycle */
+static uint8_t main_sensor_failed;
+/**
+ * \brief The instances which are read again as soon as the lock expires
+ * \details The variable is non-zero while a retry is scheduled.
+ */
+static uint8_t main_sensor_retry;
+/** \brief The number of retries of the current failure */
+static uint8_t main_sensor_attempts;
+/** \brief The number of ticks since the current read cycle started */
+static uint8_t main_sensor_readTicks;
 /**
- * \brief The last temperature result of channel 1
- * \details The variable can be safely accessed outside an interrupt context if
- * the main_sensor_state is IDLE.
+ * \brief The pending instances which are started after every other instance
+ * completed
+ * \details The 1-Wire interrupt routine blocks the edge interrupts of the
+ * AM2303 for up to 13 us. Hence, the 1-Wire traffic must not overlap with the
+ * AM2303 read cycle.
  */
-static volatile uint16_t main_am2303_temperature_chn1;
+static uint8_t main_sensor_waiting;
 /**
- * \brief The last humidity result of channel 1
- * \details The variable can be safely accessed outside an interrupt context if
- * the main_sensor_state is IDLE.
+ * \brief The number of consecutive failed read cycles of each instance
+ * \details The values saturate at 255 and are reported by the quality fields.
  */
-static volatile uint16_t main_am2303_humidity_chn1;
+static uint8_t main_sensor_quality[MAIN_SENSOR_COUNT];
+/** \brief The last valid values of each instance */
+static int16_t main_sensor_values[MAIN_SENSOR_COUNT][SENSOR_MAX_VALUES];
+
+#ifdef USE_BUTTON_CNT
+/** \brief The button fields which have to be selected explicitly */
+#define MAIN_REPLY_OPTIONAL_BUTTON (1UL << MAIN_REPLY_INDEX_buttonEvents)
+#else
+#define MAIN_REPLY_OPTIONAL_BUTTON (0)
+#endif
+
+#ifdef USE_DEW_POINT
+/** \brief Describes the derived values of a humidity sensor instance */
+typedef struct {
+	const sensor_driver_t *driver; ///< \brief The driver of the instance
+	uint8_t channel; ///< \brief The channel of the driver
+	/** \brief The offset of the dew point field in the reply */
+	uint8_t dewPointOffset;
+	/** \brief The offset of the absolute humidity field in the reply */
+	uint8_t absHumidityOffset;
+} main_dewPoint_t;
+
+/** \brief Expands to the description of the derived values of an instance */
+#define MAIN_DEW_POINT_ENTRY(driver, channel, dewPointField, absHumidityField) \
+	{ &(driver), (channel), offsetof(main_reply_enc_t, dewPointField), \
+		offsetof(main_reply_enc_t, absHumidityField) },
+
+/** \brief Every instance with derived values, see \ref sensor-config.h */
+static const main_dewPoint_t main_dewPoints[] = {
+		SENSOR_CONFIG_DEW_POINT(MAIN_DEW_POINT_ENTRY) };
+
+/** \brief The number of instances with derived values */
+#define MAIN_DEW_POINT_COUNT (sizeof(main_dewPoints) / sizeof(main_dewPoints[0]))
+
+/**
+ * \brief The last valid dew point and absolute humidity of each instance
+ * \details The values are computed whenever new readings are recorded.
+ */
+static int16_t main_dewPoint_values[MAIN_DEW_POINT_COUNT][2];
 #endif
 
-/** \brief The number of ticks until the am2303 sensors may be read again */
-static uint8_t main_am2303_lockedTicks;
+/** \brief Describes the read statistics fields of a humidity sensor channel */
+typedef struct {
+	/** \brief The offset of the completed read cycles field in the reply */
+	uint8_t readsOffset;
+	/** \brief The offset of the checksum errors field in the reply */
+	uint8_t chksumErrorsOffset;
+} main_statistics_t;
+
+/** \brief Expands to the description of the read statistics fields */
+#define MAIN_STATISTICS_ENTRY(readsField, chksumErrorsField) \
+	{ offsetof(main_reply_enc_t, readsField), \
+		offsetof(main_reply_enc_t, chksumErrorsField) },
+
+/**
+ * \brief The read statistics fields of every humidity sensor channel
+ * \details The index corresponds to the channel of \ref am2303_driver.
+ */
+static const main_statistics_t main_statistics[] = {
+		MAIN_STATISTICS_ENTRY(readsChn0, chksumErrorsChn0)
+#ifdef USE_AM2303_CHN1
+		MAIN_STATISTICS_ENTRY(readsChn1, chksumErrorsChn1)
+#endif
+};
+
+/** \brief The number of humidity sensor channels with read statistics */
+#define MAIN_STATISTICS_COUNT \
+	(sizeof(main_statistics) / sizeof(main_statistics[0]))
+
+#ifdef USE_ADC
+/** \brief Expands to the offset of the reply field of an analog channel */
+#define MAIN_ADC_OFFSET(mux, field) offsetof(main_reply_enc_t, field),
+
+/** \brief The reply field offset of every analog channel */
+static const uint8_t main_adcOffsets[] = { ADC_CONFIG(MAIN_ADC_OFFSET) };
+
+/** \brief The number of analog channels */
+#define MAIN_ADC_COUNT (sizeof(main_adcOffsets) / sizeof(main_adcOffsets[0]))
+#endif
+
+/** \brief The number of network channels (links) */
+#define MAIN_CHANNEL_COUNT (4)
+
+#ifdef USE_BUTTON_CNT
+/** \brief The channels whose clients select the button events */
+#define MAIN_BUTTON_EVENT_LINKS (main_buttonEventLinks())
+/**
+ * \brief Indicates queued button events which have to be pushed
+ * \details The events stay queued as long as no client selects them.
+ */
+#define MAIN_BUTTON_EVENTS_PENDING \
+	(button_cnt_getEventCount() != 0 && MAIN_BUTTON_EVENT_LINKS)
+#else
+#define MAIN_BUTTON_EVENT_LINKS (0)
+#define MAIN_BUTTON_EVENTS_PENDING (0)
+#endif
+
+#ifdef USE_BUTTON_LED
+/** \brief The color of the pixels which show a positive button counter */
+#define MAIN_BUTTON_LED_POSITIVE 0x00, 0x80, 0x00
+/** \brief The color of the pixels which show a negative button counter */
+#define MAIN_BUTTON_LED_NEGATIVE 0x80, 0x00, 0x00
+#endif
+
+/**
+ * \brief The fields which are selected by the client of each channel
+ * \details The bit number corresponds to the position of the field in
+ * \ref FRAME_CONFIG_REPLY. The selection is set by a field mask request and is
+ * used for every subsequent reply and push message of the channel. It is
+ * reset to \ref MAIN_REPLY_DEFAULT_FIELDS by \ref main_resetLink whenever a
+ * client connects to or disconnects from the channel.
+ */
+static uint32_t main_linkFieldMask[MAIN_CHANNEL_COUNT];
+
+/**
+ * \brief The message buffer which holds the selected fields of the reply
+ * \details The buffer is only used if a channel selects other than the default
+ * fields. It must not be altered while the bufferBusy flag is set.
+ */
+static uint8_t main_projectionBuffer[sizeof(main_reply_enc_t)];
+
+/**
+ * \brief Flag which indicates that the reply buffer holds outdated values
+ * \details The flag is set if a value changes while the reply buffer is busy.
+ * Every writer runs in the main loop.
+ */
+static uint8_t main_replyStale;
+
+/** \brief The number of ticks until the sensors may be read again */
+static uint8_t main_sensor_lockedTicks;
 
 /**
  * \brief Encapsulates some of the data belonging to the main module.
@@ -98,23 +385,91 @@ static struct {
 	uint8_t buttonFlags :3;
 	/** \brief Flag which indicates whether the message buffer is busy */
 	int8_t bufferBusy :1;
+	/**
+	 * \brief Flags which indicate that a given channel still needs to receive
+	 * the current push message
+	 * \details The bit number corresponds to the network channel
+	 */
+	uint8_t pushFlags :4;
+	/** \brief The button flags which are reported by the current push message */
+	uint8_t pushButtonFlags :3;
 } main_data;
 
 // Function Prototypes
 static void main_init(void);
 static void main_timedTick(void);
 static void main_tick(void);
-static void main_fetchData(void);
-void main_recordData(status_t status, uint16_t temperature, uint16_t humidity,
-		uint8_t channel);
+static void main_fetchData(uint8_t sensors);
+static void main_startSensors(uint8_t sensors);
+#ifdef USE_DS18B20
+static uint8_t main_driverInstances(const sensor_driver_t *driver);
+#endif
+void main_recordData(const sensor_driver_t *driver, uint8_t channel,
+		status_t status, const int16_t *values);
+static void main_continueReadCycle(void);
+static void main_finishReadCycle(void);
+static void main_failPending(void);
+static void main_patchSensor(uint8_t sensor);
+static void main_patchStatistics(void);
+#ifdef USE_ADC
+static void main_patchAdc(void);
+#endif
+#ifdef USE_DEW_POINT
+static void main_computeDewPoint(const sensor_driver_t *driver,
+		uint8_t channel, const int16_t *values);
+static void main_patchDewPoint(uint8_t index);
+#endif
+static uint8_t main_lowestChannel(uint8_t flags);
 static void main_sendData(uint8_t channel);
+static void main_updateReplyField(uint8_t *field, int16_t value);
+static void main_refreshReply(void);
 void main_freeReplyBuffer(status_t status);
 void main_decodeMessage(status_t status, uint8_t channel, uint8_t size,
 		uint8_t rrbID);
+static status_t main_decodeFieldMask(uint8_t channel, uint8_t size,
+		uint8_t rrbID);
+void main_resetLink(uint8_t channel);
 #ifdef USE_BUTTON_CNT
 void main_handleButtonEvent(int16_t cnt, uint8_t btn);
+static uint8_t main_buttonEventLinks(void);
+static void main_encodeButtonEvents(uint8_t fetch);
+#endif
+#ifdef USE_BUTTON_LED
+static void main_showButtonCounter(int16_t cnt);
 #endif
 #ifdef USE_WS2801
+/** \brief Declares the types of the LED command */
+IEC61499_COM_DECLARE_FRAME(main_ws2801Cmd, FRAME_CONFIG_WS2801)
+static status_t main_ws2801Cmd_decode(uint8_t rrbID, uint8_t size,
+		main_ws2801Cmd_t *value);
+/** \brief Declares the types of the LED range fill command */
+IEC61499_COM_DECLARE_FRAME(main_ws2801Fill, FRAME_CONFIG_WS2801_FILL)
+static status_t main_ws2801Fill_decode(uint8_t rrbID, uint8_t size,
+		main_ws2801Fill_t *value);
+#ifdef USE_WS2801_PALETTE
+/** \brief Declares the types of the LED palette command */
+IEC61499_COM_DECLARE_FRAME(main_ws2801Palette, FRAME_CONFIG_WS2801_PALETTE)
+static status_t main_ws2801Palette_decode(uint8_t rrbID, uint8_t size,
+		main_ws2801Palette_t *value);
+#endif
+#ifdef USE_WS2801_GAMMA
+/** \brief Declares the types of the LED brightness command */
+IEC61499_COM_DECLARE_FRAME(main_ws2801Brightness,
+		FRAME_CONFIG_WS2801_BRIGHTNESS)
+static status_t main_ws2801Brightness_decode(uint8_t rrbID, uint8_t size,
+		main_ws2801Brightness_t *value);
+#endif
+#ifdef USE_WS2801_ANIMATION
+/** \brief Declares the types of the LED animation command */
+IEC61499_COM_DECLARE_FRAME(main_ws2801Animation, FRAME_CONFIG_WS2801_ANIMATION)
+static status_t main_ws2801Animation_decode(uint8_t rrbID, uint8_t size,
+		main_ws2801Animation_t *value);
+static status_t main_decodeWS2801Animation(uint8_t size, uint8_t rrbID);
+#endif
+static status_t main_decodeWS2801Batch(uint8_t size, uint8_t rrbID,
+		uint8_t *update);
+static status_t main_decodeWS2801Frame(uint8_t size, uint8_t rrbID,
+		uint8_t *update);
 void main_decodeWS2801Command(uint8_t size, uint8_t rrbID);
 #endif
 
@@ -139,21 +494,34 @@ int main(void) {
 	// Main tasking scheme:
 	while (1) {
 		esp8266_transc_tick();
+		deferred_tick();
 		main_tick();
 
-#ifdef USE_BUTTON_CNT
 		// Fast timer tick
 		if (system_timer_queryFast()) {
+#ifdef USE_BUTTON_CNT
 			button_cnt_timedFastTick();
-		}
 #endif
+#ifdef USE_WS2801
+			ws2801_timedFastTick();
+#endif
+#ifdef USE_WS2801_ANIMATION
+			ws2801_animation_timedFastTick();
+#endif
+#ifdef USE_SHT3X
+			sht3x_timedFastTick();
+#endif
+		}
 
 		// Standard timer tick
 		if (system_timer_query()) {
 			esp8266_session_timedTick();
 			main_timedTick();
-#ifdef USE_WS2801
-			ws2801_timedTick();
+#ifdef USE_DS18B20
+			ds18b20_timedTick();
+#endif
+#ifdef USE_SHT3X
+			twi_timedTick();
 #endif
 		}
 	}
@@ -167,6 +535,12 @@ int main(void) {
  * the function.
  */
 static void main_init(void) {
+	uint8_t i;
+
+	for (i = 0; i < MAIN_CHANNEL_COUNT; i++) {
+		main_linkFieldMask[i] = MAIN_REPLY_DEFAULT_FIELDS;
+	}
+
 	oscillator_init();
 	system_timer_init();
 #ifdef USE_BUTTON_CNT
@@ -175,51 +549,109 @@ static void main_init(void) {
 #ifdef USE_WS2801
 	ws2801_init();
 #endif
+#ifdef USE_WS2801_ANIMATION
+	ws2801_animation_init();
+#endif
+	deferred_init();
 	am2303_init();
-	esp8266_session_init(main_decodeMessage);
+#ifdef USE_DS18B20
+	ds18b20_init();
+#endif
+#ifdef USE_SHT3X
+	twi_init();
+	sht3x_init();
+#endif
+#ifdef USE_ADC
+	adc_init();
+#endif
+	esp8266_session_init(main_decodeMessage, main_resetLink);
 }
 
 /**
- * \brief Maintains the \ref main_am2303_lockedTicks variable
+ * \brief Maintains the \ref main_sensor_lockedTicks variable
+ * \details A read cycle which exceeds \ref MAIN_SENSOR_TIMEOUT_MS is finished.
+ * The latest analog results are patched into the reply as well.
  */
 static void main_timedTick(void) {
-	if (main_am2303_lockedTicks > 0) {
-		main_am2303_lockedTicks--;
+	if (main_sensor_lockedTicks > 0) {
+		main_sensor_lockedTicks--;
+	}
+	if (main_sensor_state == READ_SENSORS) {
+		main_sensor_readTicks++;
+		if (main_sensor_readTicks
+				> SYSTEM_TIMER_MS_TO_TICKS(MAIN_SENSOR_TIMEOUT_MS)) {
+			main_failPending();
+		}
 	}
+#ifdef USE_ADC
+	main_patchAdc();
+#endif
 }
 
 /**
  * \brief Implements the network task which initiates new sending operations.
  * \details The task checks the sensor status and the request flags. If recent
- * data is available it assembles the message and send it.
+ * data is available it assembles the message and send it. Pressed buttons are
+ * pushed to every channel one after another such that each channel receives
+ * its selected fields. Queued button events alone are only pushed to the
+ * channels which select them.
  */
 static void main_tick(void) {
-	main_sensorState_t sensorState;
-	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
-	{
-		sensorState = main_sensor_state;
-	}
+	main_sensorState_t sensorState = main_sensor_state;
+
+	if ((main_data.buttonFlags || MAIN_BUTTON_EVENTS_PENDING)
+			&& !main_data.pushFlags && !main_data.bufferBusy) {
 
-	if (main_data.buttonFlags && !main_data.bufferBusy) {
+		// Start pushing the data initiated by the user
+		uint8_t eventLinks = MAIN_BUTTON_EVENT_LINKS;
 
-		// Push data initiated by the user
 		DEBUG_PRINT(0x03, main_data.buttonFlags);
-		main_sendData(0xFF);
+		main_data.pushFlags = (main_data.buttonFlags ?
+				(1 << MAIN_CHANNEL_COUNT) - 1 : eventLinks);
+		main_data.pushButtonFlags = main_data.buttonFlags;
 		main_data.buttonFlags = 0;
+#ifdef USE_BUTTON_CNT
+		main_updateReplyField(main_replyBuffer.buttonFlags,
+				(int16_t) main_data.pushButtonFlags);
+		main_encodeButtonEvents(eventLinks != 0);
+#endif
+	}
+
+	if (main_data.pushFlags && !main_data.bufferBusy) {
+
+		// Push data to the next channel
+		uint8_t chn = main_lowestChannel(main_data.pushFlags);
+		main_data.pushFlags &= ~(1 << chn);
+
+		main_sendData(chn);
+
+		if (!main_data.pushFlags) {
+			main_data.pushButtonFlags = 0;
+#ifdef USE_BUTTON_CNT
+			main_updateReplyField(main_replyBuffer.buttonFlags, 0);
+			if (main_data.bufferBusy) {
+				main_replyStale = 1;
+			} else {
+				main_encodeButtonEvents(0);
+			}
+#endif
+		}
+
+	} else if (sensorState == IDLE && main_sensor_retry
+			&& main_sensor_lockedTicks == 0) {
+
+		// Repeat a failed read cycle
+		main_fetchData(main_sensor_retry);
 
 	} else if (sensorState == IDLE && main_data.requestFlags) {
 
 		// Data requested by a connected client
 		DEBUG_PRINT(0x01, main_data.requestFlags);
 
-		if (main_am2303_lockedTicks == 0) {
-			main_fetchData();
+		if (main_sensor_lockedTicks == 0) {
+			main_fetchData(MAIN_SENSOR_ALL);
 		} else if (!main_data.bufferBusy) {
-			uint8_t chn = 0;
-			// Determine channel number
-			while (!(main_data.requestFlags & (1 << chn)) || chn >= 3) {
-				chn++;
-			}
+			uint8_t chn = main_lowestChannel(main_data.requestFlags);
 			main_data.requestFlags &= ~(1 << chn);
 
 			main_sendData(chn);
@@ -229,71 +661,116 @@ static void main_tick(void) {
 }
 
 /**
- * \brief Assembles a data message and initiates the transmission
+ * \brief Returns the number of the lowest channel whose flag is set
+ * \param flags The channel flags. It is assumed that at least one flag is set.
+ * \return The channel number
+ */
+static uint8_t main_lowestChannel(uint8_t flags) {
+	uint8_t chn = 0;
+	while (!(flags & (1 << chn))) {
+		chn++;
+	}
+	return chn;
+}
+
+/**
+ * \brief Initiates the transmission of the pre-encoded reply message
  * \details It is assumed that the bufferBusy flag is cleared before calling the
- * function. Any transmission error will be ignored. The connected client has to
- * initiate a re-transmission if the server fails.
+ * function. Only the fields which are selected by the channel are sent. The
+ * default fields are the prefix of the reply buffer and are sent without
+ * copying. Other selections are copied to \ref main_projectionBuffer. Any
+ * transmission error will be ignored. The connected client has to initiate a
+ * re-transmission if the server fails.
  * \param channel A valid channel identifier which specifies the destination
- * channel or 0xFF to send a broadcast message
+ * channel
  */
 static void main_sendData(uint8_t channel) {
-	static uint8_t replyBuffer[4 * IEC61499_COM_INT_ENC_SIZE];
-	uint8_t nextIndex = 0;
-	status_t status;
-
-	// Encodes the values
-	iec61499_com_encodeINT(replyBuffer,
-			sizeof(replyBuffer) / sizeof(replyBuffer[0]), &nextIndex,
-			main_am2303_temperature_chn0);
-	iec61499_com_encodeINT(replyBuffer,
-			sizeof(replyBuffer) / sizeof(replyBuffer[0]), &nextIndex,
-			main_am2303_humidity_chn0);
-#ifdef USE_AM2303_CHN1
-	iec61499_com_encodeINT(replyBuffer,
-			sizeof(replyBuffer) / sizeof(replyBuffer[0]), &nextIndex,
-			main_am2303_temperature_chn1);
-	iec61499_com_encodeINT(replyBuffer,
-			sizeof(replyBuffer) / sizeof(replyBuffer[0]), &nextIndex,
-			main_am2303_humidity_chn1);
-#endif
-#ifdef USE_BUTTON_CNT
-	iec61499_com_encodeINT(replyBuffer,
-			sizeof(replyBuffer) / sizeof(replyBuffer[0]), &nextIndex,
-			button_cnt_getCounter());
-	iec61499_com_encodeINT(replyBuffer,
-			sizeof(replyBuffer) / sizeof(replyBuffer[0]), &nextIndex,
-			(int16_t) main_data.buttonFlags);
-#endif
-
-	// Sends the message
-	if (channel == 0xFF) {
-		status = esp8266_session_sendToAll(replyBuffer, nextIndex,
-				main_freeReplyBuffer);
-	} else {
-		status = esp8266_session_send(channel, replyBuffer, nextIndex,
-				main_freeReplyBuffer);
+	uint32_t mask = main_linkFieldMask[channel];
+	uint8_t *buffer = (uint8_t*) &main_replyBuffer;
+	uint8_t size = sizeof(main_replyBuffer);
+
+	if (mask == MAIN_REPLY_DEFAULT_FIELDS) {
+		size = MAIN_REPLY_DEFAULT_SIZE;
+	} else if (mask != MAIN_REPLY_ALL_FIELDS) {
+		size = iec61499_com_projectFrame(main_projectionBuffer, &main_replyBuffer,
+				main_replyFieldSizes, MAIN_REPLY_FIELD_COUNT, mask);
+		buffer = main_projectionBuffer;
 	}
 
-	if (status == success) {
+	if (esp8266_session_send(channel, buffer, size, main_freeReplyBuffer)
+			== success) {
 		main_data.bufferBusy = 1;
 	}
 
 }
 
+/**
+ * \brief Patches a single value of the reply message
+ * \details If the reply buffer is currently busy, the buffer is left untouched
+ * and the update is deferred until \ref main_freeReplyBuffer is called. The
+ * function must not be called in an interrupt context.
+ * \param field The encoded INT or UINT field of \ref main_replyBuffer to
+ * update. Both types share the same value encoding.
+ * \param value The new value of the field
+ */
+static void main_updateReplyField(uint8_t *field, int16_t value) {
+	if (main_data.bufferBusy) {
+		main_replyStale = 1;
+	} else {
+		iec61499_com_updateINT(field, value);
+	}
+}
+
+/**
+ * \brief Patches every value of the reply message
+ * \details It is assumed that the reply buffer is not busy and that the
+ * function is called outside an interrupt context.
+ */
+static void main_refreshReply(void) {
+	uint8_t i;
+
+	main_replyStale = 0;
+	for (i = 0; i < MAIN_SENSOR_COUNT; i++) {
+		main_patchSensor(i);
+	}
+	main_patchStatistics();
+#ifdef USE_ADC
+	main_patchAdc();
+#endif
+#ifdef USE_DEW_POINT
+	for (i = 0; i < MAIN_DEW_POINT_COUNT; i++) {
+		main_patchDewPoint(i);
+	}
+#endif
+#ifdef USE_BUTTON_CNT
+	main_updateReplyField(main_replyBuffer.buttonCnt, button_cnt_getCounter());
+	main_updateReplyField(main_replyBuffer.buttonFlags,
+			(int16_t) main_data.pushButtonFlags);
+	if (!main_data.pushFlags) {
+		main_encodeButtonEvents(0);
+	}
+#endif
+}
+
 /**
  * \brief Clears the busy flag of the reply buffer
+ * \details Values which changed during the transmission are patched into the
+ * reply buffer.
  * \param status The status of the previously performed operation. Since
  * re-transmission is delegated to the client, any error will be ignored.
  */
 void main_freeReplyBuffer(status_t status) {
 	main_data.bufferBusy = 0;
+	if (main_replyStale) {
+		main_refreshReply();
+	}
 }
 
 /**
  * \brief Decodes the previously received message and takes corresponding
  * actions
  * \details Any message with a status code other than success will be ignored.
- * Currently, every received message will result in a reply request. It is
+ * Every received message will result in a reply request. It is
  * assumed that every given parameter is valid. See
  * \ref esp8266_transc_messageReceived for a detailed description of the
  * parameters
@@ -304,121 +781,678 @@ void main_decodeMessage(status_t status, uint8_t channel, uint8_t size,
 	if (status == success) {
 		main_data.requestFlags |= (1 << channel);
 
+		if (main_decodeFieldMask(channel, size, rrbID) != success) {
 #ifdef USE_WS2801
-		main_decodeWS2801Command(size, rrbID);
+			main_decodeWS2801Command(size, rrbID);
 #endif
+		}
+	}
+}
+
+/**
+ * \brief Restores the default field selection of the given channel
+ * \details The function is called if a client connected to or disconnected
+ * from the channel. Hence, a new client never inherits the selection of the
+ * previous client of the channel. See \ref esp8266_transc_linkChanged.
+ * \param channel The channel of the link
+ */
+void main_resetLink(uint8_t channel) {
+	main_linkFieldMask[channel] = MAIN_REPLY_DEFAULT_FIELDS;
+}
+
+/**
+ * \brief Tries to decode a field mask request
+ * \details The request consists of a single UDINT value. Each bit selects a
+ * field of the reply message in the order given by \ref FRAME_CONFIG_REPLY.
+ * The LSB selects the first field. A single UINT value is accepted as well. It
+ * selects among the first 16 fields only. The selection is stored for the given
+ * channel and applies to every subsequent reply and push message until the
+ * link is closed. A mask which doesn't select any existing field restores the
+ * default selection given by \ref MAIN_REPLY_DEFAULT_FIELDS.
+ * \param channel The channel which received the request
+ * \param size The number of received bytes
+ * \param rrbID The round robin buffer ID of the first byte.
+ * \return success if and only if the message was a field mask request
+ */
+static status_t main_decodeFieldMask(uint8_t channel, uint8_t size,
+		uint8_t rrbID) {
+	status_t err;
+	uint8_t nextIndex = 0;
+	uint16_t shortMask;
+	uint32_t mask;
+
+	err = iec61499_com_decodeUDINT(rrbID, size, &nextIndex, &mask);
+	if (err != success) {
+		nextIndex = 0;
+		err = iec61499_com_decodeUINT(rrbID, size, &nextIndex, &shortMask);
+		mask = shortMask;
 	}
+	if (err == success && nextIndex == size) {
+		mask &= MAIN_REPLY_ALL_FIELDS;
+		main_linkFieldMask[channel] = (mask ? mask : MAIN_REPLY_DEFAULT_FIELDS);
+		return success;
+	}
+	return err_invalidMagicNumber;
 }
 
 #ifdef USE_WS2801
 /**
  * \brief Tries to decode the WS2801 command in the receive buffer
  * \details If the command was parsed successfully, it will be executed
- * immediately. The first USINT corresponds to the pixel number, the next three
- * USINT values denote the RGB value and the BOOL flag indicates whether to
- * update the values.
+ * immediately. The command either sets a single pixel as given by
+ * \ref FRAME_CONFIG_WS2801, fills a range of pixels as given by
+ * \ref FRAME_CONFIG_WS2801_FILL, sets a sequence of pixels as described by
+ * \ref main_decodeWS2801Batch or sets the whole image as described by
+ * \ref main_decodeWS2801Frame. In palette mode, the command may set a palette
+ * entry as given by \ref FRAME_CONFIG_WS2801_PALETTE. If the color correction
+ * is enabled, the command may set the brightness as given by
+ * \ref FRAME_CONFIG_WS2801_BRIGHTNESS. If the animation engine
+ * is enabled, the command may start an animation as given by
+ * \ref FRAME_CONFIG_WS2801_ANIMATION. A running animation is stopped as soon
+ * as a command which sets pixels or palette entries was executed successfully.
+ * Since the LED command of the 4diac client sets a pixel, clients which want
+ * to keep the animation running have to poll with a field mask request, see
+ * \ref main_decodeFieldMask. Messages which fail to decode and brightness
+ * commands don't affect the animation.
  * \param size The number of received bytes
  * \param rrbID The round robin buffer ID of the first byte.
  */
 void main_decodeWS2801Command(uint8_t size, uint8_t rrbID) {
 	status_t err;
-	uint8_t nextIndex = 0;
-	uint8_t pos = 0, rVal = 0, gVal = 0, bVal = 0, update = 0;
+	uint8_t update = 0;
+	main_ws2801Cmd_t cmd;
+	main_ws2801Fill_t fill;
+#ifdef USE_WS2801_PALETTE
+	main_ws2801Palette_t palette;
+#endif
+#ifdef USE_WS2801_GAMMA
+	main_ws2801Brightness_t brightness;
+#endif
 
-	err = iec61499_com_decodeUSINT(rrbID, size, &nextIndex, &pos);
-	IEC6199_COM_TRY(err,
-			iec61499_com_decodeUSINT(rrbID, size, &nextIndex, &rVal));
-	IEC6199_COM_TRY(err,
-			iec61499_com_decodeUSINT(rrbID, size, &nextIndex, &gVal));
-	IEC6199_COM_TRY(err,
-			iec61499_com_decodeUSINT(rrbID, size, &nextIndex, &bVal));
-	IEC6199_COM_TRY(err,
-			iec61499_com_decodeBOOL(rrbID, size, &nextIndex, &update));
+#ifdef USE_WS2801_ANIMATION
+	if (size == sizeof(main_ws2801Animation_enc_t)) {
+		err = main_decodeWS2801Animation(size, rrbID);
+		DEBUG_PRINT(0x03, err);
+		return;
+	}
+#endif
+#ifdef USE_WS2801_GAMMA
+	if (size == sizeof(main_ws2801Brightness_enc_t)) {
+		err = main_ws2801Brightness_decode(rrbID, size, &brightness);
+		if (err == success) {
+			ws2801_setBrightness(brightness.brightness);
+			if (brightness.update) {
+				(void) ws2801_update();
+			}
+		}
+		DEBUG_PRINT(0x03, err);
+		return;
+	}
+#endif
+
+	err = main_decodeWS2801Frame(size, rrbID, &update);
+	if (err == err_invalidMagicNumber) {
+		err = main_decodeWS2801Batch(size, rrbID, &update);
+	}
+	if (err == err_invalidMagicNumber) {
+#ifdef USE_WS2801_PALETTE
+		if (size == sizeof(main_ws2801Palette_enc_t)) {
+			err = main_ws2801Palette_decode(rrbID, size, &palette);
+			if (err == success) {
+				err = ws2801_setPaletteEntry(palette.index, palette.red,
+						palette.green, palette.blue);
+			}
+		} else
+#endif
+		if (size == sizeof(main_ws2801Fill_enc_t)) {
+			err = main_ws2801Fill_decode(rrbID, size, &fill);
+			if (err == success) {
+				err = ws2801_fillValues(fill.position, fill.count, fill.red,
+						fill.green, fill.blue);
+				update = fill.update;
+			}
+		} else {
+			err = main_ws2801Cmd_decode(rrbID, size, &cmd);
+			if (err == success) {
+				err = ws2801_setValue(cmd.position, cmd.red, cmd.green,
+						cmd.blue);
+				update = cmd.update;
+			}
+		}
+	}
 
 	DEBUG_PRINT(0x03, err);
 
 	if (err == success) {
-		(void) ws2801_setValue(pos, rVal, gVal, bVal);
+#ifdef USE_WS2801_ANIMATION
+		ws2801_animation_stop();
+#endif
 		if (update) {
 			(void) ws2801_update();
 		}
 	}
 
 }
+
+#ifdef USE_WS2801_ANIMATION
+/**
+ * \brief Tries to decode and start the LED animation command
+ * \param size The number of received bytes
+ * \param rrbID The round robin buffer ID of the first byte.
+ * \return The status of the operation.
+ */
+static status_t main_decodeWS2801Animation(uint8_t size, uint8_t rrbID) {
+	status_t err;
+	main_ws2801Animation_t cmd;
+	ws2801_animation_color_t primary, secondary;
+
+	err = main_ws2801Animation_decode(rrbID, size, &cmd);
+	if (err == success) {
+		primary.red = cmd.red;
+		primary.green = cmd.green;
+		primary.blue = cmd.blue;
+		secondary.red = cmd.redSecondary;
+		secondary.green = cmd.greenSecondary;
+		secondary.blue = cmd.blueSecondary;
+		err = ws2801_animation_start(cmd.mode, cmd.period, &primary,
+				&secondary);
+	}
+	return err;
+}
+#endif
+
+/**
+ * \brief Tries to decode and execute the batched LED command
+ * \details The command consists of the USINT start position, an ARRAY of USINT
+ * values and the BOOL update flag. The array holds the red, green and blue
+ * value of each consecutive pixel. The whole message is validated before the
+ * colors are copied from the receive buffer to the pixel buffer in a single
+ * pass. Pixels beyond the end of the chain are ignored.
+ * \param size The number of received bytes
+ * \param rrbID The round robin buffer ID of the first byte.
+ * \param update Receives the update flag of the command
+ * \return The status of the operation. err_invalidMagicNumber indicates that
+ * the message isn't a batched command.
+ */
+static status_t main_decodeWS2801Batch(uint8_t size, uint8_t rrbID,
+		uint8_t *update) {
+	status_t err;
+	uint8_t nextIndex = 0;
+	uint8_t valueIndex, position, count;
+
+	err = iec61499_com_decodeUSINT(rrbID, size, &nextIndex, &position);
+	IEC6199_COM_TRY(err,
+			iec61499_com_decodeARRAYHeader(rrbID, size, &nextIndex,
+					IEC61499_COM_TAG_USINT, 0xFF, &count));
+	if (err != success) {
+		return err_invalidMagicNumber;
+	}
+	if (count % 3 != 0) {
+		return err_sizeOutOfBounds;
+	}
+
+	valueIndex = nextIndex;
+	nextIndex += count;
+	err = iec61499_com_decodeBOOL(rrbID, size, &nextIndex, update);
+
+	while (err == success && count > 0 && position < WS2801_CHAIN_SIZE) {
+		err = ws2801_setValue(position,
+				esp8266_receiver_getByte(rrbID, valueIndex),
+				esp8266_receiver_getByte(rrbID, valueIndex + 1),
+				esp8266_receiver_getByte(rrbID, valueIndex + 2));
+		valueIndex += 3;
+		count -= 3;
+		position++;
+	}
+
+	return err;
+}
+
+/**
+ * \brief Tries to decode and execute the run length encoded image command
+ * \details The command consists of a single ARRAY of USINT values. The array
+ * holds groups of four values each: the number of consecutive pixels followed
+ * by their red, green and blue value. The runs are applied from the first pixel
+ * on and every pixel behind the last run is turned off. The whole message is
+ * validated before the runs are copied from the receive buffer to the pixel
+ * buffer in a single pass. The command always updates the LED chain.
+ * \param size The number of received bytes
+ * \param rrbID The round robin buffer ID of the first byte.
+ * \param update Receives the update flag of the command
+ * \return The status of the operation. err_invalidMagicNumber indicates that
+ * the message isn't an image command.
+ */
+static status_t main_decodeWS2801Frame(uint8_t size, uint8_t rrbID,
+		uint8_t *update) {
+	status_t err = success;
+	uint8_t nextIndex = 0;
+	uint8_t position = 0;
+	uint8_t count, run;
+
+	if (iec61499_com_decodeARRAYHeader(rrbID, size, &nextIndex,
+			IEC61499_COM_TAG_USINT, 0xFF, &count) != success) {
+		return err_invalidMagicNumber;
+	}
+	if (count % 4 != 0 || nextIndex + count != size) {
+		return err_sizeOutOfBounds;
+	}
+
+	while (err == success && count > 0 && position < WS2801_CHAIN_SIZE) {
+		run = esp8266_receiver_getByte(rrbID, nextIndex);
+		err = ws2801_fillValues(position, run,
+				esp8266_receiver_getByte(rrbID, nextIndex + 1),
+				esp8266_receiver_getByte(rrbID, nextIndex + 2),
+				esp8266_receiver_getByte(rrbID, nextIndex + 3));
+		position = (run < WS2801_CHAIN_SIZE - position ?
+				position + run : WS2801_CHAIN_SIZE);
+		nextIndex += 4;
+		count -= 4;
+	}
+	if (err == success && position < WS2801_CHAIN_SIZE) {
+		err = ws2801_fillValues(position, WS2801_CHAIN_SIZE - position, 0, 0,
+				0);
+	}
+
+	*update = 1;
+	return err;
+}
+
+/** \brief Decodes the LED command with a single bounds check */
+static IEC61499_COM_DEFINE_DECODER(main_ws2801Cmd, FRAME_CONFIG_WS2801)
+
+/** \brief Decodes the LED range fill command with a single bounds check */
+static IEC61499_COM_DEFINE_DECODER(main_ws2801Fill, FRAME_CONFIG_WS2801_FILL)
+
+#ifdef USE_WS2801_GAMMA
+/** \brief Decodes the LED brightness command with a single bounds check */
+static IEC61499_COM_DEFINE_DECODER(main_ws2801Brightness,
+		FRAME_CONFIG_WS2801_BRIGHTNESS)
+#endif
+
+#ifdef USE_WS2801_ANIMATION
+/** \brief Decodes the LED animation command with a single bounds check */
+static IEC61499_COM_DEFINE_DECODER(main_ws2801Animation,
+		FRAME_CONFIG_WS2801_ANIMATION)
+#endif
+
+#ifdef USE_WS2801_PALETTE
+/** \brief Decodes the LED palette command with a single bounds check */
+static IEC61499_COM_DEFINE_DECODER(main_ws2801Palette,
+		FRAME_CONFIG_WS2801_PALETTE)
+#endif
 #endif
 
 /**
  * \brief Initiates fetching the sensor data and maintains the sensor status
  * \details It is assumed that the current sensor status in
- * \ref main_sensor_state is IDLE and that \ref main_am2303_lockedTicks equals
- * zero.
+ * \ref main_sensor_state is IDLE and that \ref main_sensor_lockedTicks equals
+ * zero. If an AM2303 instance is read, the DS18B20 instances are started as
+ * soon as every other instance completed, see \ref main_sensor_waiting.
+ * \param sensors The instances to read. Bit n selects instance n of
+ * \ref main_sensors.
  */
-static void main_fetchData(void) {
-	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
-	{
-		main_sensor_state = READ_AM2303_CHN0;
+static void main_fetchData(uint8_t sensors) {
+	main_sensor_state = READ_SENSORS;
+	main_sensor_pending = sensors;
+	main_sensor_failed = 0;
+	main_sensor_retry = 0;
+	main_sensor_readTicks = 0;
+	main_sensor_lockedTicks = SYSTEM_TIMER_MS_TO_TICKS(MAIN_SENSOR_PERIOD_MS);
+
+	main_sensor_waiting = 0;
+#ifdef USE_DS18B20
+	if (sensors & main_driverInstances(&am2303_driver)) {
+		main_sensor_waiting = sensors & main_driverInstances(&ds18b20_driver);
 	}
-	main_am2303_lockedTicks = SYSTEM_TIMER_MS_TO_TICKS(10000);
-	am2303_startReading(0, main_recordData);
+#endif
+	main_startSensors(sensors & ~main_sensor_waiting);
+	main_continueReadCycle();
 }
 
-#ifdef USE_AM2303_CHN1
 /**
- * \brief Stores the fetched data locally and sets the sensor state
- * \details The function starts reading the second humidity sensor if the first
- * one was queried. If the status is not successful, the readings are skipped
- * and the next sensor is queried.
+ * \brief Starts the drivers of the given instances
+ * \details The selected instances of the same driver are started at once such
+ * that the driver may read them concurrently. Instances whose driver can't be
+ * started are failed immediately.
+ * \param sensors The instances to start. Bit n selects instance n of
+ * \ref main_sensors.
  */
-void main_recordData(status_t status, uint16_t temperature, uint16_t humidity,
-		uint8_t channel) {
+static void main_startSensors(uint8_t sensors) {
+	uint8_t i, j, channels, group;
+	uint8_t started = 0;
 
-	if (channel == 0) {
+	for (i = 0; i < MAIN_SENSOR_COUNT; i++) {
+		if (sensors & ~started & (1 << i)) {
 
-		if (status == success) {
-			main_am2303_temperature_chn0 = temperature;
-			main_am2303_humidity_chn0 = humidity;
-		}
-		main_sensor_state = READ_AM2303_CHN1;
-		am2303_startReading(1, main_recordData);
+			// Collect every selected instance of the same driver
+			channels = 0;
+			group = 0;
+			for (j = i; j < MAIN_SENSOR_COUNT; j++) {
+				if ((sensors & (1 << j))
+						&& main_sensors[j].driver == main_sensors[i].driver) {
+					channels |= 1 << main_sensors[j].channel;
+					group |= 1 << j;
+				}
+			}
+			started |= group;
 
-	} else if (channel == 1) {
-		if (status == success) {
-			main_am2303_temperature_chn1 = temperature;
-			main_am2303_humidity_chn1 = humidity;
+			if (main_sensors[i].driver->start(channels, main_recordData)
+					!= success) {
+				main_sensor_pending &= ~group;
+				main_sensor_failed |= group;
+			}
 		}
-		main_sensor_state = IDLE;
 	}
+}
 
-	DEBUG_PRINT(0x02, status);
+#ifdef USE_DS18B20
+/**
+ * \brief Returns every instance of the given driver
+ * \param driver The descriptor of the driver
+ * \return The instances. Bit n corresponds to instance n of \ref main_sensors.
+ */
+static uint8_t main_driverInstances(const sensor_driver_t *driver) {
+	uint8_t instances = 0;
+	uint8_t i;
 
+	for (i = 0; i < MAIN_SENSOR_COUNT; i++) {
+		if (main_sensors[i].driver == driver) {
+			instances |= 1 << i;
+		}
+	}
+	return instances;
 }
-#else
+#endif
+
 /**
  * \brief Stores the fetched data locally and sets the sensor state
- * \details If the status is not successful, the readings are skipped and the
- * state is set to IDLE
+ * \details The function is the callback of every sensor driver. If the status
+ * is not successful, the readings are skipped and the failure is counted by
+ * the quality field of the instance. Otherwise, the derived humidity values are
+ * updated as well. Afterwards, the read cycle is continued by
+ * \ref main_continueReadCycle.
  */
-void main_recordData(status_t status, uint16_t temperature, uint16_t humidity,
-		uint8_t channel) {
+void main_recordData(const sensor_driver_t *driver, uint8_t channel,
+		status_t status, const int16_t *values) {
+	uint8_t i, k;
 
-	if (channel == 0) {
-		if (status == success) {
-			main_am2303_temperature_chn0 = temperature;
-			main_am2303_humidity_chn0 = humidity;
+	for (i = 0; i < MAIN_SENSOR_COUNT; i++) {
+		if (main_sensors[i].driver == driver
+				&& main_sensors[i].channel == channel) {
+			break;
 		}
-		main_sensor_state = IDLE;
+	}
+	if (i == MAIN_SENSOR_COUNT || !(main_sensor_pending & (1 << i))) {
+		return;
 	}
 
+	if (status == success) {
+		main_sensor_quality[i] = 0;
+		for (k = 0; k < driver->valueCount && k < SENSOR_MAX_VALUES; k++) {
+			main_sensor_values[i][k] = values[k];
+		}
+#ifdef USE_DEW_POINT
+		main_computeDewPoint(driver, channel, values);
+#endif
+	} else {
+		main_sensor_failed |= 1 << i;
+		if (main_sensor_quality[i] < UINT8_MAX) {
+			main_sensor_quality[i]++;
+		}
+	}
+	main_patchSensor(i);
+	if (driver == &am2303_driver) {
+		main_patchStatistics();
+	}
+
+	main_sensor_pending &= ~(1 << i);
+	main_continueReadCycle();
+
 	DEBUG_PRINT(0x02, status);
 }
+
+/**
+ * \brief Starts the waiting instances or finishes the read cycle
+ * \details The waiting instances are started as soon as every other instance
+ * completed. The read cycle is finished as soon as every instance completed.
+ */
+static void main_continueReadCycle(void) {
+	uint8_t waiting = main_sensor_waiting;
+
+	if (waiting && !(main_sensor_pending & ~waiting)) {
+		main_sensor_waiting = 0;
+		main_startSensors(waiting);
+	}
+	if (!main_sensor_pending) {
+		main_finishReadCycle();
+	}
+}
+
+/**
+ * \brief Finishes the read cycle and schedules a retry if necessary
+ * \details If an instance failed, a retry of the failed instances is
+ * scheduled. The delay of the retry starts at \ref MAIN_SENSOR_RETRY_MS and
+ * doubles with every attempt. After \ref MAIN_SENSOR_RETRY_COUNT attempts, the
+ * regular interval applies again.
+ */
+static void main_finishReadCycle(void) {
+	if (main_sensor_failed && main_sensor_attempts < MAIN_SENSOR_RETRY_COUNT) {
+		main_sensor_lockedTicks = SYSTEM_TIMER_MS_TO_TICKS(
+				MAIN_SENSOR_RETRY_MS) << main_sensor_attempts;
+		main_sensor_attempts++;
+		main_sensor_retry = main_sensor_failed;
+	} else {
+		main_sensor_attempts = 0;
+	}
+	main_sensor_state = IDLE;
+}
+
+/**
+ * \brief Fails every instance which didn't complete the read cycle yet
+ * \details Each instance is recorded with err_timeout. Hence, the read cycle
+ * finishes and a retry is scheduled. Waiting instances aren't started anymore.
+ * A late completion of a driver is ignored.
+ */
+static void main_failPending(void) {
+	uint8_t i;
+
+	DEBUG_PRINT(0x04, main_sensor_pending);
+	main_sensor_waiting = 0;
+	for (i = 0; i < MAIN_SENSOR_COUNT; i++) {
+		if (main_sensor_pending & (1 << i)) {
+			main_recordData(main_sensors[i].driver, main_sensors[i].channel,
+					err_timeout, NULL);
+		}
+	}
+}
+
+/**
+ * \brief Patches the values and the quality of the given instance into the
+ * reply message
+ * \param sensor The index of the instance in \ref main_sensors
+ */
+static void main_patchSensor(uint8_t sensor) {
+	const main_sensor_t *desc = &main_sensors[sensor];
+	uint8_t k;
+
+	for (k = 0; k < desc->driver->valueCount && k < SENSOR_MAX_VALUES; k++) {
+		main_updateReplyField(
+				MAIN_REPLY_FIELD(desc->valueOffset + k * IEC61499_COM_INT_ENC_SIZE),
+				main_sensor_values[sensor][k]);
+	}
+	main_updateReplyField(MAIN_REPLY_FIELD(desc->qualityOffset),
+			main_sensor_quality[sensor]);
+}
+
+/**
+ * \brief Patches the read statistics of every humidity sensor channel into
+ * the reply message
+ */
+static void main_patchStatistics(void) {
+	am2303_statistics_t statistics;
+	uint8_t i;
+
+	for (i = 0; i < MAIN_STATISTICS_COUNT; i++) {
+		if (am2303_getStatistics(i, &statistics) == success) {
+			main_updateReplyField(
+					MAIN_REPLY_FIELD(main_statistics[i].readsOffset),
+					(int16_t) statistics.reads);
+			main_updateReplyField(
+					MAIN_REPLY_FIELD(main_statistics[i].chksumErrorsOffset),
+					(int16_t) statistics.chksumErrors);
+		}
+	}
+}
+
+#ifdef USE_ADC
+/**
+ * \brief Patches the latest result of every analog channel into the reply
+ * message
+ */
+static void main_patchAdc(void) {
+	uint8_t i;
+
+	for (i = 0; i < MAIN_ADC_COUNT; i++) {
+		main_updateReplyField(MAIN_REPLY_FIELD(main_adcOffsets[i]),
+				adc_getValue(i));
+	}
+}
+#endif
+
+#ifdef USE_DEW_POINT
+/**
+ * \brief Derives the dew point and the absolute humidity of the given instance
+ * \details The values are only updated if the instance is listed by
+ * \ref SENSOR_CONFIG_DEW_POINT and if the readings are in the supported range.
+ * \param driver The driver of the instance
+ * \param channel The channel of the driver
+ * \param values The temperature followed by the relative humidity
+ */
+static void main_computeDewPoint(const sensor_driver_t *driver,
+		uint8_t channel, const int16_t *values) {
+	uint8_t i;
+
+	for (i = 0; i < MAIN_DEW_POINT_COUNT; i++) {
+		if (main_dewPoints[i].driver == driver
+				&& main_dewPoints[i].channel == channel) {
+			if (humidity_compute(values[0], values[1], &main_dewPoint_values[i][0],
+					&main_dewPoint_values[i][1]) == success) {
+				main_patchDewPoint(i);
+			}
+			return;
+		}
+	}
+}
+
+/**
+ * \brief Patches the derived values of the given instance into the reply
+ * message
+ * \param index The index of the instance in \ref main_dewPoints
+ */
+static void main_patchDewPoint(uint8_t index) {
+	main_updateReplyField(
+			MAIN_REPLY_FIELD(main_dewPoints[index].dewPointOffset),
+			main_dewPoint_values[index][0]);
+	main_updateReplyField(
+			MAIN_REPLY_FIELD(main_dewPoints[index].absHumidityOffset),
+			main_dewPoint_values[index][1]);
+}
 #endif
 
 #ifdef USE_BUTTON_CNT
 /**
  * \brief Registers the button event to be sent as soon as possible
+ * \details The counter value is patched into the reply immediately. The button
+ * flags are patched as soon as the push message is initiated. If enabled, the
+ * counter is shown on the LED chain as soon as it changes.
  */
 void main_handleButtonEvent(int16_t cnt, uint8_t btn) {
 	main_data.buttonFlags |= btn;
+	main_updateReplyField(main_replyBuffer.buttonCnt, cnt);
+#ifdef USE_BUTTON_LED
+	if (btn & 0x06) { // Up or down
+		main_showButtonCounter(cnt);
+	}
+#endif
+}
+#endif
+
+#ifdef USE_BUTTON_CNT
+/**
+ * \brief Returns the channels whose clients select the button events
+ * \return The bit mask of the channels
+ */
+static uint8_t main_buttonEventLinks(void) {
+	uint8_t links = 0;
+	uint8_t i;
+
+	for (i = 0; i < MAIN_CHANNEL_COUNT; i++) {
+		if (main_linkFieldMask[i] & MAIN_REPLY_OPTIONAL_BUTTON) {
+			links |= (1 << i);
+		}
+	}
+	return links;
+}
+
+/**
+ * \brief Encodes the button events field of the reply
+ * \details The events are fetched from the event queue of the button counter
+ * module. It is assumed that the reply buffer isn't busy. Each event is
+ * encoded as described by \ref IEC61499_COM_BUTTON_EVENTS_TEMPLATE. If events
+ * were discarded, the first element is marked by
+ * \ref BUTTON_CNT_OVERFLOW_FLAG.
+ * \param fetch If non-zero, the queued events will be moved to the reply.
+ * Otherwise, the field will be cleared.
+ */
+static void main_encodeButtonEvents(uint8_t fetch) {
+	uint32_t events[BUTTON_CNT_QUEUE_SIZE];
+	button_cnt_event_t event;
+	uint8_t nextIndex = 0;
+	uint8_t i;
+
+	for (i = 0; i < BUTTON_CNT_QUEUE_SIZE; i++) {
+		if (fetch && button_cnt_popEvent(&event)) {
+			events[i] = ((uint32_t) event.type << 24)
+					| ((uint32_t) event.button << 16) | event.time;
+		} else {
+			events[i] = 0;
+		}
+	}
+	if (fetch && button_cnt_fetchOverflows()) {
+		events[0] |= (uint32_t) BUTTON_CNT_OVERFLOW_FLAG << 24;
+	}
+
+	iec61499_com_encodeARRAY(main_replyBuffer.buttonEvents,
+			sizeof(main_replyBuffer.buttonEvents), &nextIndex,
+			IEC61499_COM_TAG_UDINT, events, BUTTON_CNT_QUEUE_SIZE);
+}
+#endif
+
+#ifdef USE_BUTTON_LED
+/**
+ * \brief Shows the button counter on the LED chain
+ * \details The counter is shown as a bar which starts at the first pixel. The
+ * length of the bar corresponds to the absolute value of the counter and its
+ * color indicates the sign. The bar is shown until the next LED command of the
+ * controller overrides it.
+ * \param cnt The current counter value
+ */
+static void main_showButtonCounter(int16_t cnt) {
+	uint8_t length;
+
+#ifdef USE_WS2801_ANIMATION
+	ws2801_animation_stop();
+#endif
+
+	if (cnt < 0) {
+		length = (cnt < -WS2801_CHAIN_SIZE ? WS2801_CHAIN_SIZE : -cnt);
+		(void) ws2801_fillValues(0, length, MAIN_BUTTON_LED_NEGATIVE);
+	} else {
+		length = (cnt > WS2801_CHAIN_SIZE ? WS2801_CHAIN_SIZE : cnt);
+		(void) ws2801_fillValues(0, length, MAIN_BUTTON_LED_POSITIVE);
+	}
+	(void) ws2801_fillValues(length, WS2801_CHAIN_SIZE - length, 0, 0, 0);
+	(void) ws2801_update();
 }
 #endif
 
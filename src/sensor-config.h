@@ -0,0 +1,103 @@
+/**
+ * \file sensor-config.h
+ * \brief The file lists every sensor instance which is read by the application
+ * \details The list is a macro which applies the passed SENSOR macro to every
+ * instance. An instance is given by the descriptor of its driver, the channel
+ * of the driver and two fields of the reply layout in \ref frame-config.h. The
+ * values of the instance are reported by consecutive INT fields which start at
+ * the value field. The quality field holds the number of consecutive failed
+ * read cycles. At most eight instances are supported. Instances which are not
+ * listed don't occupy any memory. A second list selects the humidity sensor
+ * instances whose dew point and absolute humidity are derived.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef SENSOR_CONFIG_H_
+#define SENSOR_CONFIG_H_
+
+#include "sensor.h"
+#include "am2303.h"
+#include "ds18b20.h"
+#include "sht3x.h"
+
+#ifdef USE_AM2303_CHN1
+/** \brief The second channel of the humidity sensor */
+#define SENSOR_CONFIG_AM2303_CHN1(SENSOR) \
+	SENSOR(am2303_driver, 1, temperatureChn1, qualityChn1)
+#else
+#define SENSOR_CONFIG_AM2303_CHN1(SENSOR)
+#endif
+
+#ifdef USE_DS18B20
+/** \brief The sensors on the 1-Wire bus */
+#define SENSOR_CONFIG_DS18B20(SENSOR) \
+	SENSOR(ds18b20_driver, 0, temperatureDs0, qualityDs0) \
+	SENSOR(ds18b20_driver, 1, temperatureDs1, qualityDs1)
+#else
+#define SENSOR_CONFIG_DS18B20(SENSOR)
+#endif
+
+#ifdef USE_SHT3X
+/** \brief The humidity sensor on the TWI bus */
+#define SENSOR_CONFIG_SHT3X(SENSOR) \
+	SENSOR(sht3x_driver, 0, temperatureSht0, qualitySht0)
+#else
+#define SENSOR_CONFIG_SHT3X(SENSOR)
+#endif
+
+/** \brief The list of every sensor instance */
+#define SENSOR_CONFIG(SENSOR) \
+	SENSOR(am2303_driver, 0, temperatureChn0, qualityChn0) \
+	SENSOR_CONFIG_AM2303_CHN1(SENSOR) \
+	SENSOR_CONFIG_DS18B20(SENSOR) \
+	SENSOR_CONFIG_SHT3X(SENSOR)
+
+#ifdef USE_DEW_POINT
+#ifdef USE_AM2303_CHN1
+/** \brief The derived values of the second humidity sensor channel */
+#define SENSOR_CONFIG_DEW_POINT_CHN1(DEW_POINT) \
+	DEW_POINT(am2303_driver, 1, dewPointChn1, absHumidityChn1)
+#else
+#define SENSOR_CONFIG_DEW_POINT_CHN1(DEW_POINT)
+#endif
+
+#ifdef USE_SHT3X
+/** \brief The derived values of the TWI humidity sensor */
+#define SENSOR_CONFIG_DEW_POINT_SHT3X(DEW_POINT) \
+	DEW_POINT(sht3x_driver, 0, dewPointSht0, absHumiditySht0)
+#else
+#define SENSOR_CONFIG_DEW_POINT_SHT3X(DEW_POINT)
+#endif
+
+/**
+ * \brief The list of every humidity sensor instance whose derived values are
+ * reported
+ * \details Each instance is given by the descriptor of its driver, the channel
+ * of the driver, the dew point field and the absolute humidity field. The
+ * instance must be listed by \ref SENSOR_CONFIG and has to deliver the
+ * temperature followed by the relative humidity.
+ */
+#define SENSOR_CONFIG_DEW_POINT(DEW_POINT) \
+	DEW_POINT(am2303_driver, 0, dewPointChn0, absHumidityChn0) \
+	SENSOR_CONFIG_DEW_POINT_CHN1(DEW_POINT) \
+	SENSOR_CONFIG_DEW_POINT_SHT3X(DEW_POINT)
+#else
+#define SENSOR_CONFIG_DEW_POINT(DEW_POINT)
+#endif
+
+#endif /* SENSOR_CONFIG_H_ */
@@ -0,0 +1,72 @@
+/**
+ * \file sensor.h
+ * \brief Specifies the common interface of every sensor driver
+ * \details Each sensor driver provides a constant driver descriptor. The
+ * descriptor holds the function which starts a read cycle and the number of
+ * values the driver delivers per channel. The application lists the used
+ * sensor instances in \ref sensor-config.h and reads every instance via the
+ * descriptor only. Every value is a signed 16 bit integer in tenths of the
+ * physical unit, e.g. 0.1 degree Celsius or 0.1 percent relative humidity.
+ * Hence, the values can be reported as INT without any conversion.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef SENSOR_H_
+#define SENSOR_H_
+
+#include "error.h"
+
+#include <stdint.h>
+
+/** \brief The maximal number of values per sensor channel */
+#define SENSOR_MAX_VALUES (2)
+
+struct sensor_driver;
+
+/**
+ * \brief Defines a callback function type which indicates a completed read
+ * cycle of a single channel
+ * \details The function is called outside an interrupt context. If and only if
+ * the given status is <code>success</code>, the values are valid.
+ * \param driver The descriptor of the driver which completed the read cycle
+ * \param channel The channel of the driver
+ * \param status The status of the operation
+ * \param values The received values. The array holds valueCount elements of
+ * the driver's descriptor. It is only valid during the call.
+ */
+typedef void (*sensor_readDone_t)(const struct sensor_driver *driver,
+		uint8_t channel, status_t status, const int16_t *values);
+
+/** \brief Describes a sensor driver */
+typedef struct sensor_driver {
+	/**
+	 * \brief Starts a read cycle of the given channels
+	 * \details The channels are read concurrently if the driver supports it.
+	 * The callback function is invoked once per selected channel but never
+	 * before the function returned. The function returns an error if the read
+	 * cycle could not be started. In this case, the callback function won't be
+	 * invoked.
+	 * \param channels The channels to read. Bit n selects channel n.
+	 * \param callback The function which indicates a completed channel
+	 */
+	status_t (*start)(uint8_t channels, sensor_readDone_t callback);
+	/** \brief The number of values per channel */
+	uint8_t valueCount;
+} sensor_driver_t;
+
+#endif /* SENSOR_H_ */
@@ -0,0 +1,249 @@
+/**
+ * \file sht3x.c
+ * \brief Implements the module which reads the SHT3x sensors
+ * \details Each channel is read by two TWI transfers. The first one sends the
+ * measurement command and the second one fetches the result. In between, the
+ * module waits for a few fast system timer ticks. The sensor doesn't stretch
+ * the clock but doesn't acknowledge its address until the measurement is
+ * finished. Hence, a not acknowledged read is repeated a few times.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "sht3x.h"
+#include "twi.h"
+#include "system_timer.h"
+#include "debug.h"
+
+#include <stdint.h>
+
+/** \brief The address of the first channel */
+#define SHT3X_ADDRESS (0x44)
+
+/** \brief The single shot command with high repeatability, no clock stretching */
+#define SHT3X_CMD_MEASURE_MSB (0x24)
+/** \brief The second byte of the measurement command */
+#define SHT3X_CMD_MEASURE_LSB (0x00)
+
+/** \brief The maximal duration of the measurement in milliseconds */
+#define SHT3X_MEASURE_MS (16)
+
+/**
+ * \brief The number of fast ticks to wait for the result
+ * \details One tick is added since the first tick may follow immediately.
+ */
+#define SHT3X_MEASURE_TICKS (SYSTEM_TIMER_MS_TO_FAST_TICKS(SHT3X_MEASURE_MS) + 1)
+
+/** \brief The number of repeated reads if the sensor isn't ready yet */
+#define SHT3X_READ_RETRIES (2)
+
+/** \brief The number of bytes of a result including both CRC bytes */
+#define SHT3X_RESULT_SIZE (6)
+
+/** \brief The CRC polynomial x^8 + x^5 + x^4 + 1 */
+#define SHT3X_CRC_POLYNOMIAL (0x31)
+/** \brief The initial value of the CRC */
+#define SHT3X_CRC_INIT (0xFF)
+
+/** \brief Nothing to do */
+#define STATE_IDLE (0)
+/** \brief Sends the measurement command */
+#define STATE_MEASURE (1)
+/** \brief Waits until the measurement is finished */
+#define STATE_WAIT (2)
+/** \brief Fetches the result */
+#define STATE_READ (3)
+
+/** \brief The state of the read cycle */
+static uint8_t sht3x_state;
+/** \brief The channels which still have to be read */
+static uint8_t sht3x_requested;
+/** \brief The currently read channel */
+static uint8_t sht3x_channel;
+/** \brief The number of fast ticks until the result is fetched */
+static uint8_t sht3x_waitTicks;
+/** \brief The number of remaining reads of the current channel */
+static uint8_t sht3x_retries;
+/** \brief The assigned callback function */
+static sensor_readDone_t sht3x_callback;
+/** \brief The buffer of the TWI transfers */
+static uint8_t sht3x_buffer[SHT3X_RESULT_SIZE];
+
+const sensor_driver_t sht3x_driver = { sht3x_startReading, 2 };
+
+/* Function prototypes */
+static void sht3x_readNext(void);
+static status_t sht3x_measure(void);
+static void sht3x_continue(uint8_t status);
+static void sht3x_report(status_t status);
+static uint8_t sht3x_crc(const uint8_t *data);
+
+void sht3x_init(void) {
+	sht3x_state = STATE_IDLE;
+	sht3x_requested = 0;
+}
+
+status_t sht3x_startReading(uint8_t channels, sensor_readDone_t callback) {
+	status_t status;
+
+	if (channels == 0 || (channels & ~((1 << SHT3X_CHANNEL_COUNT) - 1))) {
+		return err_invalidChannel;
+	}
+	if (sht3x_state != STATE_IDLE) {
+		return err_invalidState;
+	}
+
+	sht3x_callback = callback;
+	sht3x_requested = channels;
+	status = sht3x_measure();
+	if (status != success) {
+		sht3x_state = STATE_IDLE;
+		sht3x_requested = 0;
+	}
+	return status;
+}
+
+void sht3x_timedFastTick(void) {
+	status_t status;
+
+	if (sht3x_state != STATE_WAIT) {
+		return;
+	}
+	sht3x_waitTicks--;
+	if (sht3x_waitTicks > 0) {
+		return;
+	}
+
+	sht3x_state = STATE_READ;
+	status = twi_transfer(SHT3X_ADDRESS + sht3x_channel, sht3x_buffer, 0,
+			SHT3X_RESULT_SIZE, sht3x_continue);
+	if (status != success) {
+		sht3x_report(status);
+	}
+}
+
+/**
+ * \brief Starts the measurement of the next requested channel
+ * \details If every channel was read, the module is idle afterwards.
+ */
+static void sht3x_readNext(void) {
+	status_t status;
+
+	if (sht3x_requested == 0) {
+		sht3x_state = STATE_IDLE;
+		return;
+	}
+
+	status = sht3x_measure();
+	if (status != success) {
+		sht3x_report(status);
+	}
+}
+
+/**
+ * \brief Sends the measurement command to the lowest requested channel
+ * \return The status of the operation
+ */
+static status_t sht3x_measure(void) {
+	sht3x_channel = 0;
+	while (!(sht3x_requested & (1 << sht3x_channel))) {
+		sht3x_channel++;
+	}
+
+	sht3x_state = STATE_MEASURE;
+	sht3x_retries = SHT3X_READ_RETRIES;
+	sht3x_buffer[0] = SHT3X_CMD_MEASURE_MSB;
+	sht3x_buffer[1] = SHT3X_CMD_MEASURE_LSB;
+	return twi_transfer(SHT3X_ADDRESS + sht3x_channel, sht3x_buffer, 2, 0,
+			sht3x_continue);
+}
+
+/**
+ * \brief Continues the read cycle after a TWI transfer completed
+ * \details The function is executed as deferred work item.
+ * \param status The status of the transfer
+ */
+static void sht3x_continue(uint8_t status) {
+	if (sht3x_state == STATE_MEASURE) {
+		if (status == success) {
+			sht3x_state = STATE_WAIT;
+			sht3x_waitTicks = SHT3X_MEASURE_TICKS;
+		} else {
+			sht3x_report(status);
+		}
+
+	} else if (sht3x_state == STATE_READ) {
+		if (status == err_noSignal && sht3x_retries > 0) {
+			// The measurement isn't finished yet
+			sht3x_retries--;
+			sht3x_state = STATE_WAIT;
+			sht3x_waitTicks = 1;
+		} else if (status != success) {
+			sht3x_report(status);
+		} else if (sht3x_crc(&sht3x_buffer[0]) != sht3x_buffer[2]
+				|| sht3x_crc(&sht3x_buffer[3]) != sht3x_buffer[5]) {
+			sht3x_report(err_chksum);
+		} else {
+			sht3x_report(success);
+		}
+	}
+}
+
+/**
+ * \brief Reports the result of the current channel and reads the next one
+ * \details The raw values of the buffer are converted if the status indicates
+ * success. The temperature is given by -45 + 175 * raw / (2^16 - 1) degree
+ * Celsius and the humidity by 100 * raw / (2^16 - 1) percent.
+ * \param status The status of the operation
+ */
+static void sht3x_report(status_t status) {
+	int16_t values[2] = { 0, 0 };
+	uint16_t raw;
+
+	if (status == success) {
+		raw = ((uint16_t) sht3x_buffer[0] << 8) | sht3x_buffer[1];
+		values[0] = (int16_t) ((1750UL * raw + UINT16_MAX / 2) / UINT16_MAX)
+				- 450;
+		raw = ((uint16_t) sht3x_buffer[3] << 8) | sht3x_buffer[4];
+		values[1] = (int16_t) ((1000UL * raw + UINT16_MAX / 2) / UINT16_MAX);
+	} else {
+		DEBUG_PRINT(0x09, status);
+	}
+
+	sht3x_requested &= ~(1 << sht3x_channel);
+	sht3x_callback(&sht3x_driver, sht3x_channel, status, values);
+	sht3x_readNext();
+}
+
+/**
+ * \brief Computes the CRC of a single 16 bit word
+ * \param data The most significant byte followed by the least significant byte
+ * \return The CRC of the word
+ */
+static uint8_t sht3x_crc(const uint8_t *data) {
+	uint8_t crc = SHT3X_CRC_INIT;
+	uint8_t i, j;
+
+	for (i = 0; i < 2; i++) {
+		crc ^= data[i];
+		for (j = 0; j < 8; j++) {
+			crc = (crc & 0x80 ? (crc << 1) ^ SHT3X_CRC_POLYNOMIAL : crc << 1);
+		}
+	}
+	return crc;
+}
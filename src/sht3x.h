@@ -0,0 +1,78 @@
+/**
+ * \file sht3x.h
+ * \brief Reads the temperature and the humidity of SHT3x sensors
+ * \details The sensors are connected to the TWI bus of \ref twi.h. Channel n
+ * denotes the sensor at address 0x44 + n, i.e. the ADDR pin of the second
+ * sensor is pulled high. Every read cycle triggers a single shot measurement
+ * with high repeatability. The result is fetched after the measurement time
+ * elapsed and is verified by its CRC. Each channel delivers the temperature
+ * followed by the relative humidity, both in 0.1 units, like the channels of
+ * \ref am2303.h. The module implements the interface of \ref sensor.h.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef SHT3X_H_
+#define SHT3X_H_
+
+#include <stdint.h>
+
+#include "error.h"
+#include "sensor.h"
+
+/** \brief The number of supported sensors */
+#define SHT3X_CHANNEL_COUNT (2)
+
+/**
+ * \brief The driver descriptor of the module
+ * \details Each channel delivers the temperature in 0.1 degree Celsius and the
+ * relative humidity in 0.1 percent.
+ */
+extern const sensor_driver_t sht3x_driver;
+
+/**
+ * \brief Initializes the module
+ * \details The function must be called after \ref twi_init and before calling
+ * any other function of the module.
+ */
+void sht3x_init(void);
+
+/**
+ * \brief Requests the values of one or more sensors
+ * \details The selected channels are read one after another. After a channel
+ * was read, the callback function is invoked. The function must not be called
+ * before the callback function was invoked for every selected channel of the
+ * previous request.
+ * \param channels The channels to read. Bit n selects channel n.
+ * \param callback The callback function which indicates a completed request.
+ * It is invoked by deferred_tick() outside an interrupt context.
+ * \return The status of the operation. err_invalidChannel indicates that no
+ * or an unsupported channel was selected. err_invalidState indicates that the
+ * previous request is still in progress or that the TWI bus is busy. In both
+ * cases, the callback function won't be invoked.
+ */
+status_t sht3x_startReading(uint8_t channels, sensor_readDone_t callback);
+
+/**
+ * \brief The time handler function which needs to be called whenever the
+ * fast system timer fires.
+ * \details The function times the measurement.
+ */
+void sht3x_timedFastTick(void);
+
+#endif /* SHT3X_H_ */
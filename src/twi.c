@@ -0,0 +1,201 @@
+/**
+ * \file twi.c
+ * \brief Implements the interrupt driven TWI (I2C) master
+ * \details Every state change of the TWI unit triggers the interrupt routine
+ * which advances the transfer according to the status code. The module
+ * occupies the following hardware resources:
+ * <ul>
+ *   <li>PC4: SDA</li>
+ *   <li>PC5: SCL</li>
+ *   <li>The TWI unit including its interrupt</li>
+ * </ul>
+ * It is assumed that the module is the only master on the bus.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "twi.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <util/twi.h>
+#include <stdint.h>
+
+#ifndef F_CPU
+#warning "The CPU frequency F_CPU is not defined. Assume 8 MHz."
+#define F_CPU (8000000UL)
+#endif
+
+/**
+ * \brief The bit rate register value without prescaler
+ * \details The SCL frequency is given by F_CPU / (16 + 2 * TWBR). The value is
+ * rounded up such that the frequency doesn't exceed \ref TWI_BITRATE.
+ */
+#define TWI_TWBR (((F_CPU + TWI_BITRATE - 1) / TWI_BITRATE - 16 + 1) / 2)
+
+#if TWI_TWBR < 10 || TWI_TWBR > 255
+#error "The TWI bit rate can't be achieved without prescaler"
+#endif
+
+/**
+ * \brief The number of system timer ticks after which a transfer is aborted
+ * \details The transfer is aborted after the second tick at the latest.
+ * Hence, at least one full timer period is granted.
+ */
+#define TWI_TIMEOUT_TICKS (2)
+
+/** \brief Enables the unit and its interrupt and clears the interrupt flag */
+#define TWI_CONTINUE (_BV(TWINT) | _BV(TWEN) | _BV(TWIE))
+
+/** \brief The 8 bit address which includes the direction bit */
+static volatile uint8_t twi_sla;
+/** \brief The transfer buffer */
+static uint8_t * volatile twi_data;
+/** \brief The number of bytes to write */
+static volatile uint8_t twi_writeSize;
+/** \brief The number of bytes to read */
+static volatile uint8_t twi_readSize;
+/** \brief The index of the next byte of the current part */
+static volatile uint8_t twi_index;
+/** \brief The work item which is posted as soon as the transfer completed */
+static volatile deferred_work_t twi_done;
+/**
+ * \brief The number of system timer ticks since the transfer started
+ * \details Zero indicates that no transfer is running.
+ */
+static volatile uint8_t twi_busy;
+
+static void twi_finish(status_t status);
+
+void twi_init(void) {
+	// Leave the internal pull-ups disabled
+	DDRC &= ~(_BV(PC4) | _BV(PC5));
+	PORTC &= ~(_BV(PC4) | _BV(PC5));
+
+	TWSR = 0; // Prescaler 1
+	TWBR = TWI_TWBR;
+	TWCR = _BV(TWEN);
+
+	twi_busy = 0;
+}
+
+status_t twi_transfer(uint8_t address, uint8_t *data, uint8_t writeSize,
+		uint8_t readSize, deferred_work_t done) {
+	if (writeSize == 0 && readSize == 0) {
+		return err_sizeOutOfBounds;
+	}
+	if (twi_busy) {
+		return err_invalidState;
+	}
+
+	twi_sla = address << 1;
+	twi_data = data;
+	twi_writeSize = writeSize;
+	twi_readSize = readSize;
+	twi_index = 0;
+	twi_done = done;
+	twi_busy = 1;
+
+	// The start condition is sent as soon as a pending stop condition was sent
+	TWCR = TWI_CONTINUE | _BV(TWSTA);
+	return success;
+}
+
+void twi_timedTick(void) {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if (twi_busy) {
+			twi_busy++;
+			if (twi_busy > TWI_TIMEOUT_TICKS) {
+				// Reset the unit which releases both lines
+				TWCR = 0;
+				TWCR = _BV(TWEN);
+				twi_busy = 0;
+				// The queue has room for the transfer, see TWI_DEFERRED_ITEMS
+				(void) deferred_post(twi_done, err_timeout);
+			}
+		}
+	}
+}
+
+/**
+ * \brief Advances the current transfer
+ * \details The status code of the TWI unit determines the next action.
+ */
+ISR(TWI_vect, ISR_BLOCK) {
+	switch (TW_STATUS) {
+	case TW_START:
+	case TW_REP_START:
+		twi_index = 0;
+		TWDR = twi_sla | (twi_writeSize > 0 ? TW_WRITE : TW_READ);
+		TWCR = TWI_CONTINUE;
+		break;
+
+	case TW_MT_SLA_ACK:
+	case TW_MT_DATA_ACK:
+		if (twi_index < twi_writeSize) {
+			TWDR = twi_data[twi_index];
+			twi_index++;
+			TWCR = TWI_CONTINUE;
+		} else if (twi_readSize > 0) {
+			// Switch to the read part
+			twi_writeSize = 0;
+			TWCR = TWI_CONTINUE | _BV(TWSTA);
+		} else {
+			twi_finish(success);
+		}
+		break;
+
+	case TW_MR_DATA_ACK:
+		twi_data[twi_index] = TWDR;
+		twi_index++;
+		// no break
+	case TW_MR_SLA_ACK:
+		// Acknowledge every byte but the last one
+		TWCR = TWI_CONTINUE
+				| (twi_index + 1 < twi_readSize ? _BV(TWEA) : 0);
+		break;
+
+	case TW_MR_DATA_NACK:
+		twi_data[twi_index] = TWDR;
+		twi_finish(success);
+		break;
+
+	case TW_MT_SLA_NACK:
+	case TW_MR_SLA_NACK:
+		twi_finish(err_noSignal);
+		break;
+
+	default:
+		// Data not acknowledged, arbitration lost or bus error
+		twi_finish(err_status);
+		break;
+	}
+}
+
+/**
+ * \brief Sends the stop condition and reports the completed transfer
+ * \details The function is called within the interrupt context.
+ * \param status The status of the transfer
+ */
+static void twi_finish(status_t status) {
+	TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWSTO);
+	twi_busy = 0;
+	// The queue has room for the transfer, see TWI_DEFERRED_ITEMS
+	(void) deferred_post(twi_done, status);
+}
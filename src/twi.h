@@ -0,0 +1,90 @@
+/**
+ * \file twi.h
+ * \brief Specifies the interface of the interrupt driven TWI (I2C) master
+ * \details The module uses the hardware TWI unit. A single transfer writes some
+ * bytes to the slave and reads some bytes afterwards. Both parts are separated
+ * by a repeated start condition. The transfer is executed by the TWI interrupt
+ * routine and its completion is reported by a deferred work item. Hence, the
+ * main loop is never blocked. The SCL (PC5) and SDA (PC4) lines require
+ * external pull-up resistors.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef TWI_H_
+#define TWI_H_
+
+#include "error.h"
+#include "deferred.h"
+
+#include <stdint.h>
+
+/** \brief The SCL frequency in Hz */
+#ifndef TWI_BITRATE
+#define TWI_BITRATE (100000UL)
+#endif
+
+/**
+ * \brief The maximal number of deferred work items which the module posts
+ * at the same time
+ * \details A transfer either completes or times out and the next transfer
+ * can't be started before the previous one was reported.
+ */
+#define TWI_DEFERRED_ITEMS (1)
+
+/**
+ * \brief Initializes the module
+ * \details The function must be called before calling any other function. It is
+ * assumed that global interrupts are not enabled and that the queue of
+ * \ref deferred.h is initialized.
+ */
+void twi_init(void);
+
+/**
+ * \brief Starts a new transfer
+ * \details The data bytes are written to the slave first. Afterwards, the read
+ * bytes are stored in the same buffer. If no byte is written, the transfer
+ * starts with the read part. The buffer must not be accessed until the transfer
+ * completed. As soon as the transfer completed, the given work item is posted.
+ * Its argument holds the status of the transfer: success, err_noSignal if the
+ * slave didn't acknowledge its address, err_status if the slave didn't
+ * acknowledge a data byte or if a bus error occurred and err_timeout if the
+ * transfer didn't complete in time.
+ * \param address The 7 bit address of the slave
+ * \param data The buffer which holds the written bytes and receives the read
+ * bytes
+ * \param writeSize The number of bytes to write
+ * \param readSize The number of bytes to read
+ * \param done The work item which is posted as soon as the transfer completed
+ * \return The status of the operation. err_invalidState indicates that the
+ * previous transfer didn't complete yet. err_sizeOutOfBounds indicates that
+ * neither a byte is written nor read. In both cases, the work item won't be
+ * posted.
+ */
+status_t twi_transfer(uint8_t address, uint8_t *data, uint8_t writeSize,
+		uint8_t readSize, deferred_work_t done);
+
+/**
+ * \brief The time handler function which needs to be called whenever the
+ * system timer fires.
+ * \details The function aborts any transfer which is stuck, e.g. if a slave
+ * holds the clock line.
+ */
+void twi_timedTick(void);
+
+#endif /* TWI_H_ */
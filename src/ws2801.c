@@ -37,6 +37,7 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <util/atomic.h>
+#include <avr/pgmspace.h>
 #include <string.h>
 
 /** \brief The channel number of the red LED */
@@ -46,6 +47,40 @@
 /** \brief The channel number of the blue LED */
 #define WS2801_BLUE_CHN (1)
 
+#if WS2801_SPI_DIVIDER == 2 || WS2801_SPI_DIVIDER == 4
+/** \brief The clock rate bits of the SPI control register */
+#define WS2801_SPCR_RATE (0)
+#elif WS2801_SPI_DIVIDER == 8 || WS2801_SPI_DIVIDER == 16
+#define WS2801_SPCR_RATE (_BV(SPR0))
+#elif WS2801_SPI_DIVIDER == 32 || WS2801_SPI_DIVIDER == 64
+#define WS2801_SPCR_RATE (_BV(SPR1))
+#elif WS2801_SPI_DIVIDER == 128
+#define WS2801_SPCR_RATE (_BV(SPR1) | _BV(SPR0))
+#else
+#error "Invalid SPI clock divider WS2801_SPI_DIVIDER"
+#endif
+
+#if WS2801_SPI_DIVIDER == 2 || WS2801_SPI_DIVIDER == 8 \
+	|| WS2801_SPI_DIVIDER == 32
+/** \brief The double speed bit of the SPI status register */
+#define WS2801_SPSR_RATE (_BV(SPI2X))
+#else
+#define WS2801_SPSR_RATE (0)
+#endif
+
+#ifdef USE_WS2801_BURST
+#if 3UL * WS2801_CHAIN_SIZE * WS2801_BURST_BYTE_CYCLES \
+	> WS2801_BURST_BUDGET_CYCLES
+#error "The burst exceeds its time budget, use the interrupt driven engine"
+#endif
+#else
+// Each transmitted byte takes eight SPI clock cycles. The next byte has to be
+// loaded within that time, otherwise the SPI idles.
+#if 8 * WS2801_SPI_DIVIDER < WS2801_ISR_CYCLES
+#error "The SPI interrupt can't keep up with the SPI clock"
+#endif
+#endif
+
 /** \brief Defines the global states of the module */
 typedef enum {
 	IDLE, ///< Waiting for a new request
@@ -53,25 +88,138 @@ typedef enum {
 	LATCH ///< Waits until the data is latched.
 } ws2801_state_t;
 
+/**
+ * \brief Holds a complete image of the LED chain
+ * \details In the default mode, the frame stores the single pixels in groups of
+ * three bytes each. The byte order corresponds to the byte order of each chip.
+ * In palette mode, each pixel is stored as a four bit palette index. The even
+ * pixels occupy the lower nibble. The palette entries are stored in the byte
+ * order of each chip.
+ */
+typedef struct {
+#ifdef USE_WS2801_PALETTE
+	uint8_t palette[3 * WS2801_PALETTE_SIZE]; ///< The colors of the palette
+	uint8_t index[(WS2801_CHAIN_SIZE + 1) / 2]; ///< The palette index per pixel
+#else
+	uint8_t pixel[3 * WS2801_CHAIN_SIZE]; ///< The color of each pixel
+#endif
+#ifdef USE_WS2801_GAMMA
+	uint8_t brightness; ///< The global brightness of the image
+#endif
+} ws2801_frame_t;
+
 /** \brief The current state of the module */
 ws2801_state_t ws2801_state;
 
+/**
+ * \brief Indicates that an update was requested while the chain was busy
+ * \details The pending update will be started as soon as the chain latched the
+ * previous frame.
+ */
+uint8_t ws2801_updatePending;
+
 /**
  * \brief Encodes the progress of the current operation.
  * \details If the module is in the WRITE_DATA state it encodes the currently
- * written byte of the buffer. If the module is in the LATCH state, it holds the
- * number of system timer ticks until the IDLE state may entered.
+ * written byte of the buffer. In palette mode, it encodes the currently written
+ * pixel instead. If the module is in the LATCH state, it holds the number of
+ * fast system timer ticks until the IDLE state may entered.
  */
 uint8_t ws2801_progress;
 
+#ifdef USE_WS2801_PALETTE
+/** \brief The currently written channel of the current pixel */
+uint8_t ws2801_channel;
+
+/** \brief Points to the palette entry of the currently written pixel */
+const uint8_t *ws2801_color;
+#endif
+
+/**
+ * \brief The number of leading pixels of the back buffer which may differ from
+ * the LED chain
+ * \details Since the chain is a shift register, only the prefix up to the last
+ * changed pixel has to be transmitted. The chips behind keep their value.
+ */
+uint8_t ws2801_dirtySize;
+
+/**
+ * \brief The number of bytes of the front buffer which are transmitted
+ * \details In palette mode, the number of transmitted pixels is stored instead.
+ */
+uint8_t ws2801_transmitSize;
+
+/**
+ * \brief The front and back data buffers which hold the complete image
+ * \details The front buffer is transmitted by the interrupt service routine
+ * while every command writes the back buffer. Both buffers are swapped whenever
+ * a transmission starts.
+ */
+ws2801_frame_t ws2801_data_buffer[2];
+
+/** \brief The buffer which is currently transmitted */
+ws2801_frame_t *ws2801_front;
+
+/** \brief The buffer which is modified by any command */
+ws2801_frame_t *ws2801_back;
+
+#ifdef USE_WS2801_GAMMA
+/**
+ * \brief Maps each linear color value to the value sent to the chip
+ * \details The table corrects the perceived brightness by a gamma of 2.2.
+ */
+static const uint8_t ws2801_gamma[256] PROGMEM = {
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+		1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2,
+		3, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6,
+		6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10, 11, 11, 11, 12,
+		12, 13, 13, 13, 14, 14, 15, 15, 16, 16, 17, 17, 18, 18, 19, 19,
+		20, 20, 21, 22, 22, 23, 23, 24, 25, 25, 26, 26, 27, 28, 28, 29,
+		30, 30, 31, 32, 33, 33, 34, 35, 35, 36, 37, 38, 39, 39, 40, 41,
+		42, 43, 43, 44, 45, 46, 47, 48, 49, 49, 50, 51, 52, 53, 54, 55,
+		56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71,
+		73, 74, 75, 76, 77, 78, 79, 81, 82, 83, 84, 85, 87, 88, 89, 90,
+		91, 93, 94, 95, 97, 98, 99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+		113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+		137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+		163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+		192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+		223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255 };
+
 /**
- * \brief The central data buffer which holds the complete image
- * \details The buffer stores the single pixels in groups of three bytes each.
- * The byte order corresponds to the byte order of each chip.
+ * \brief Returns the corrected value of the given channel value
+ * \details The gamma correction is applied before the value is scaled by the
+ * brightness of the transmitted image.
  */
-uint8_t ws2801_data_buffer[3 * WS2801_CHAIN_SIZE];
+#define WS2801_CORRECT(value) \
+	((uint8_t) (((uint16_t) pgm_read_byte(&ws2801_gamma[(value)]) \
+			* (ws2801_front->brightness + 1)) >> 8))
+#else
+#define WS2801_CORRECT(value) (value)
+#endif
+
+#ifdef USE_WS2801_PALETTE
+/**
+ * \brief The initial palette
+ * \details The table holds the red, green and blue value of each entry.
+ */
+static const uint8_t ws2801_defaultPalette[3 * WS2801_PALETTE_SIZE] PROGMEM = {
+		0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0xFF, 0x00,
+		0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0xFF,
+		0x40, 0x40, 0x40, 0xFF, 0x80, 0x00, 0x80, 0x00, 0x00, 0x00, 0x80, 0x00,
+		0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0x80 };
+#endif
+
+void ws2801_startTransmission(void);
+static inline uint8_t ws2801_nextByte(uint8_t *value);
+#ifdef USE_WS2801_PALETTE
+uint8_t ws2801_findColor(uint8_t red, uint8_t green, uint8_t blue);
+#endif
 
 void ws2801_init(void) {
+#ifdef USE_WS2801_PALETTE
+	uint8_t i;
+#endif
 
 	ws2801_state = IDLE;
 
@@ -80,15 +228,37 @@ void ws2801_init(void) {
 	DDRB |= _BV(PB5) | _BV(PB3);
 	PORTB |= _BV(PB2);
 
+#ifdef USE_WS2801_BURST
+	// Master, polled, MSBit first, sample on rising edge, low when idle
+	SPCR = _BV(SPE) | _BV(MSTR) | WS2801_SPCR_RATE;
+#else
 	// Master, enabled interrupts, MSBit first, sample on rising edge,
 	// low when idle
-	SPCR = _BV(SPIE) | _BV(SPE) | _BV(MSTR) | _BV(SPR1) | _BV(SPR0);
-	SPSR = _BV(SPI2X);
+	SPCR = _BV(SPIE) | _BV(SPE) | _BV(MSTR) | WS2801_SPCR_RATE;
+#endif
+	SPSR = WS2801_SPSR_RATE;
 
 	memset(ws2801_data_buffer, 0x00, sizeof(ws2801_data_buffer));
+	ws2801_front = &ws2801_data_buffer[0];
+	ws2801_back = &ws2801_data_buffer[1];
+	ws2801_updatePending = 0;
+#ifdef USE_WS2801_GAMMA
+	ws2801_back->brightness = UINT8_MAX;
+#endif
+#ifdef USE_WS2801_PALETTE
+	for (i = 0; i < WS2801_PALETTE_SIZE; i++) {
+		(void) ws2801_setPaletteEntry(i,
+				pgm_read_byte(&ws2801_defaultPalette[3 * i]),
+				pgm_read_byte(&ws2801_defaultPalette[3 * i + 1]),
+				pgm_read_byte(&ws2801_defaultPalette[3 * i + 2]));
+	}
+#endif
+	// The initial state of the chain is unknown
+	ws2801_dirtySize = WS2801_CHAIN_SIZE;
 }
 
-void ws2801_timedTick(void) {
+void ws2801_timedFastTick(void) {
+	uint8_t start = 0;
 
 	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
 	{
@@ -96,76 +266,272 @@ void ws2801_timedTick(void) {
 
 			if (ws2801_progress == 0) {
 				ws2801_state = IDLE;
+				start = ws2801_updatePending;
 			} else {
 				ws2801_progress--;
 			}
 
 		}
 	}
+
+	if (start) {
+		ws2801_startTransmission();
+	}
 }
 
 status_t ws2801_setValue(uint8_t position, uint8_t red, uint8_t green,
 		uint8_t blue) {
-	ws2801_state_t state;
-	uint8_t i;
-	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
-	{
-		state = ws2801_state;
+
+	if (position >= WS2801_CHAIN_SIZE) {
+		// Set all pixels
+		return ws2801_fillValues(0, WS2801_CHAIN_SIZE, red, green, blue);
+	} else {
+		// Set the given pixel
+		return ws2801_fillValues(position, 1, red, green, blue);
 	}
+}
+
+#ifdef USE_WS2801_PALETTE
+status_t ws2801_fillValues(uint8_t position, uint8_t count, uint8_t red,
+		uint8_t green, uint8_t blue) {
+	uint8_t color = ws2801_findColor(red, green, blue);
+	uint8_t *index;
+	uint8_t mask;
 
-	if (state == IDLE || state == LATCH) {
+	if (position >= WS2801_CHAIN_SIZE) {
+		return success;
+	}
+	if (count > WS2801_CHAIN_SIZE - position) {
+		count = WS2801_CHAIN_SIZE - position;
+	}
 
-		if (position >= WS2801_CHAIN_SIZE) {
-			// Set all pixels
-			for (i = 0; i < WS2801_CHAIN_SIZE; i++) {
-				ws2801_data_buffer[3 * i + WS2801_RED_CHN] = red;
-				ws2801_data_buffer[3 * i + WS2801_GREEN_CHN] = green;
-				ws2801_data_buffer[3 * i + WS2801_BLUE_CHN] = blue;
+	color |= color << 4;
+	while (count > 0) {
+		index = &ws2801_back->index[position >> 1];
+		mask = (position & 0x01) ? 0xF0 : 0x0F;
+		position++;
+		if ((*index ^ color) & mask) {
+			*index = (*index & ~mask) | (color & mask);
+			if (position > ws2801_dirtySize) {
+				ws2801_dirtySize = position;
 			}
-		} else {
-			// Set the given pixel
-			ws2801_data_buffer[3 * position + WS2801_RED_CHN] = red;
-			ws2801_data_buffer[3 * position + WS2801_GREEN_CHN] = green;
-			ws2801_data_buffer[3 * position + WS2801_BLUE_CHN] = blue;
 		}
+		count--;
+	}
+
+	return success;
+}
+
+status_t ws2801_setPaletteEntry(uint8_t index, uint8_t red, uint8_t green,
+		uint8_t blue) {
+	uint8_t *entry;
+
+	if (index >= WS2801_PALETTE_SIZE) {
+		return err_indexOutOfBounds;
+	}
+
+	entry = &ws2801_back->palette[3 * index];
+	entry[WS2801_RED_CHN] = red;
+	entry[WS2801_GREEN_CHN] = green;
+	entry[WS2801_BLUE_CHN] = blue;
+	// Any pixel may refer to the entry
+	ws2801_dirtySize = WS2801_CHAIN_SIZE;
+
+	return success;
+}
+
+/**
+ * \brief Returns the palette index of the closest color in the back buffer
+ * \details The distance is given by the sum of the absolute differences of
+ * each channel.
+ * \param red The value of the red channel.
+ * \param green The value of the green channel.
+ * \param blue The value of the blue channel.
+ * \return The index of the closest palette entry
+ */
+uint8_t ws2801_findColor(uint8_t red, uint8_t green, uint8_t blue) {
+	const uint8_t *entry = ws2801_back->palette;
+	uint16_t distance, bestDistance = UINT16_MAX;
+	uint8_t i, best = 0;
+
+	for (i = 0; i < WS2801_PALETTE_SIZE; i++) {
+		distance = (entry[WS2801_RED_CHN] > red ?
+				entry[WS2801_RED_CHN] - red : red - entry[WS2801_RED_CHN]);
+		distance += (entry[WS2801_GREEN_CHN] > green ?
+				entry[WS2801_GREEN_CHN] - green : green - entry[WS2801_GREEN_CHN]);
+		distance += (entry[WS2801_BLUE_CHN] > blue ?
+				entry[WS2801_BLUE_CHN] - blue : blue - entry[WS2801_BLUE_CHN]);
+		if (distance < bestDistance) {
+			bestDistance = distance;
+			best = i;
+		}
+		entry += 3;
+	}
 
+	return best;
+}
+#else
+status_t ws2801_fillValues(uint8_t position, uint8_t count, uint8_t red,
+		uint8_t green, uint8_t blue) {
+	uint8_t *pixel;
+
+	if (position >= WS2801_CHAIN_SIZE) {
 		return success;
-	} else {
-		return err_invalidState;
 	}
+	if (count > WS2801_CHAIN_SIZE - position) {
+		count = WS2801_CHAIN_SIZE - position;
+	}
+
+	pixel = &ws2801_back->pixel[3 * position];
+	while (count > 0) {
+		position++;
+		if (pixel[WS2801_RED_CHN] != red || pixel[WS2801_GREEN_CHN] != green
+				|| pixel[WS2801_BLUE_CHN] != blue) {
+			pixel[WS2801_RED_CHN] = red;
+			pixel[WS2801_GREEN_CHN] = green;
+			pixel[WS2801_BLUE_CHN] = blue;
+			if (position > ws2801_dirtySize) {
+				ws2801_dirtySize = position;
+			}
+		}
+		pixel += 3;
+		count--;
+	}
+
+	return success;
 }
+#endif
+
+#ifdef USE_WS2801_GAMMA
+void ws2801_setBrightness(uint8_t brightness) {
+	if (ws2801_back->brightness != brightness) {
+		ws2801_back->brightness = brightness;
+		// Every pixel changes its color
+		ws2801_dirtySize = WS2801_CHAIN_SIZE;
+	}
+}
+#endif
 
 status_t ws2801_update(void) {
-	ws2801_state_t state;
+	uint8_t start;
 	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
 	{
-		state = ws2801_state;
+		start = (ws2801_state == IDLE);
+		ws2801_updatePending = !start;
 	}
 
-	if (state == IDLE) {
+	if (start) {
+		ws2801_startTransmission();
+	}
+	return success;
+}
 
+/**
+ * \brief Swaps the buffers and starts transmitting the front buffer
+ * \details It is assumed that the module is in the IDLE state. The new back
+ * buffer is initialized with the transmitted image, so that subsequent commands
+ * modify the latest image. Only the dirty prefix of the image is transmitted.
+ * If nothing changed, the transmission will be skipped. The function must not
+ * be called from an interrupt context since it modifies the back buffer. The
+ * burst engine transmits the whole image before the function returns.
+ */
+void ws2801_startTransmission(void) {
+	ws2801_frame_t *buffer = ws2801_front;
+#ifdef USE_WS2801_BURST
+	uint8_t value;
+#endif
+
+	if (ws2801_dirtySize == 0) {
+		ws2801_updatePending = 0;
+		return;
+	}
+
+	ws2801_front = ws2801_back;
+	ws2801_back = buffer;
+	memcpy(ws2801_back, ws2801_front, sizeof(ws2801_frame_t));
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ws2801_updatePending = 0;
 		ws2801_progress = 0;
 		ws2801_state = WRITE_DATA;
-		SPDR = ws2801_data_buffer[0];
+#ifdef USE_WS2801_PALETTE
+		ws2801_transmitSize = ws2801_dirtySize;
+		ws2801_channel = 0;
+		ws2801_color = &ws2801_front->palette[3
+				* (ws2801_front->index[0] & 0x0F)];
+		SPDR = WS2801_CORRECT(ws2801_color[0]);
+#else
+		ws2801_transmitSize = 3 * ws2801_dirtySize;
+		SPDR = WS2801_CORRECT(ws2801_front->pixel[0]);
+#endif
+	}
+	ws2801_dirtySize = 0;
 
-		return success;
+#ifdef USE_WS2801_BURST
+	// Fetch the next byte while the last one is shifted out
+	while (ws2801_nextByte(&value)) {
+		loop_until_bit_is_set(SPSR, SPIF);
+		SPDR = value;
+	}
+	loop_until_bit_is_set(SPSR, SPIF);
+#endif
+}
+
+/**
+ * \brief Advances the transmission and fetches the next byte
+ * \details In palette mode, the palette index of each pixel is expanded on the
+ * fly. If enabled, the gamma correction and the brightness are applied to each
+ * byte. As soon as the buffer is fully transmitted, the LATCH state is
+ * entered.
+ * \param value Receives the next byte to transmit
+ * \return Non-zero if and only if a further byte has to be transmitted
+ */
+static inline uint8_t ws2801_nextByte(uint8_t *value) {
+#ifdef USE_WS2801_PALETTE
+	uint8_t index;
+
+	ws2801_channel++;
+	if (ws2801_channel >= 3) {
+		ws2801_channel = 0;
+		ws2801_progress++;
+		if (ws2801_progress >= ws2801_transmitSize) {
+			ws2801_state = LATCH;
+			ws2801_progress = SYSTEM_TIMER_MS_TO_FAST_TICKS(1);
+			return 0;
+		}
+		index = ws2801_front->index[ws2801_progress >> 1];
+		if (ws2801_progress & 0x01) {
+			index >>= 4;
+		}
+		ws2801_color = &ws2801_front->palette[3 * (index & 0x0F)];
+	}
+	*value = WS2801_CORRECT(ws2801_color[ws2801_channel]);
+	return 1;
+#else
+	ws2801_progress++;
+	if (ws2801_progress < ws2801_transmitSize) {
+		*value = WS2801_CORRECT(ws2801_front->pixel[ws2801_progress]);
+		return 1;
 	} else {
-		return err_invalidState;
+		ws2801_state = LATCH;
+		ws2801_progress = SYSTEM_TIMER_MS_TO_FAST_TICKS(1);
+		return 0;
 	}
+#endif
 }
 
+#ifndef USE_WS2801_BURST
 /**
  * \brief checks whether the buffer is fully transmit and initiates sending the
  * next byte.
- * \details It is assumed that the ISR is only called in state WRITE_DATA
+ * \details It is assumed that the ISR is only called in state WRITE_DATA.
  */
 ISR(SPI_STC_vect, ISR_BLOCK) {
-	ws2801_progress++;
-	if (ws2801_progress
-			< sizeof(ws2801_data_buffer) / sizeof(ws2801_data_buffer[0])) {
-		SPDR = ws2801_data_buffer[ws2801_progress];
-	} else {
-		ws2801_state = LATCH;
-		ws2801_progress = SYSTEM_TIMER_MS_TO_TICKS(1);
+	uint8_t value;
+
+	if (ws2801_nextByte(&value)) {
+		SPDR = value;
 	}
 }
+#endif
@@ -3,9 +3,15 @@
  * \brief Specifies the communication interface for the ES2801 LED driver.
  * \details Before any other function of the module can be used,
  * \ref ws2801_init has to be called. Additionally, the module requires the
- * \ref ws2801_timedTick function to be called in the interval of the system
- * timer. The content of the chained LEDs are internally buffered and allow to
- * access a single value.
+ * \ref ws2801_timedFastTick function to be called in the interval of the fast
+ * system timer. The content of the chained LEDs are internally buffered and
+ * allow to access a single value. If USE_WS2801_PALETTE is defined, each pixel
+ * will be stored as an index into a palette of WS2801_PALETTE_SIZE colors. The
+ * mode reduces the memory consumption and allows up to 255 pixels. If
+ * USE_WS2801_GAMMA is defined, each color value will be gamma corrected and
+ * scaled by a global brightness while it is transmitted. By default, each byte
+ * is transmitted by an interrupt. If USE_WS2801_BURST is defined, the image
+ * will be transmitted at the maximum SPI clock in a polled burst instead.
  *
  * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
  *
@@ -31,8 +37,75 @@
 
 #include <stdint.h>
 
+#ifndef WS2801_CHAIN_SIZE
 /** \brief The maximum number of controlled LEDs */
 #define WS2801_CHAIN_SIZE (10)
+#endif
+
+#ifdef USE_WS2801_PALETTE
+/** \brief The number of palette entries */
+#define WS2801_PALETTE_SIZE (16)
+#if WS2801_CHAIN_SIZE > 255
+#error "The palette mode supports up to 255 pixels"
+#endif
+#elif WS2801_CHAIN_SIZE > 85
+#error "Define USE_WS2801_PALETTE in order to support more than 85 pixels"
+#endif
+
+#ifndef WS2801_SPI_DIVIDER
+#ifdef USE_WS2801_BURST
+/**
+ * \brief The divider of the SPI clock
+ * \details Valid values are 2, 4, 8, 16, 32, 64 and 128. The burst engine
+ * runs at the maximum clock by default.
+ */
+#define WS2801_SPI_DIVIDER (2)
+#else
+#define WS2801_SPI_DIVIDER (64)
+#endif
+#endif
+
+/**
+ * \brief A conservative estimate of the CPU cycles spent to fetch the next byte
+ * \details The palette expansion and the color correction add their share.
+ */
+#define WS2801_BYTE_CYCLES (16 + WS2801_PALETTE_CYCLES + WS2801_GAMMA_CYCLES)
+#ifdef USE_WS2801_PALETTE
+/** \brief The additional CPU cycles of the palette expansion */
+#define WS2801_PALETTE_CYCLES (24)
+#else
+#define WS2801_PALETTE_CYCLES (0)
+#endif
+#ifdef USE_WS2801_GAMMA
+/** \brief The additional CPU cycles of the color correction */
+#define WS2801_GAMMA_CYCLES (16)
+#else
+#define WS2801_GAMMA_CYCLES (0)
+#endif
+
+#ifdef USE_WS2801_BURST
+/**
+ * \brief The maximum number of CPU cycles a burst may block the main loop
+ * \details Interrupts stay enabled during the burst. Hence, the USART is served
+ * in time. The budget bounds the delay of every other task of the main loop to
+ * a single period of the fast system timer.
+ */
+#define WS2801_BURST_BUDGET_CYCLES (256UL * 128UL)
+
+// The next byte is fetched while the current byte is shifted out
+#if 8 * WS2801_SPI_DIVIDER > WS2801_BYTE_CYCLES
+#define WS2801_BURST_BYTE_CYCLES (8 * WS2801_SPI_DIVIDER + 4)
+#else
+#define WS2801_BURST_BYTE_CYCLES (WS2801_BYTE_CYCLES + 4)
+#endif
+#else
+/**
+ * \brief A conservative estimate of the CPU cycles spent per transmitted byte
+ * \details The estimate covers the interrupt latency, the prologue and epilogue
+ * of the interrupt service routine and fetching the next byte.
+ */
+#define WS2801_ISR_CYCLES (48 + WS2801_BYTE_CYCLES)
+#endif
 
 /**
  * \brief Initializes the module
@@ -44,33 +117,77 @@ void ws2801_init(void);
 
 /**
  * \brief Maintains periodic tasks
- * \details The function has to be called whenever the system timer fires.
+ * \details The function has to be called whenever the fast system timer
+ * fires.
  */
-void ws2801_timedTick(void);
+void ws2801_timedFastTick(void);
 
 /**
  * \brief Sets the the color at the given position in the internal buffer.
  * \details The function does not directly update the status of the LEDs. In
  * order to update the LED chain, \ref ws2801_update has to be called. If the
  * position value is bigger or equal than WS2801_CHAIN_SIZE, all elements of the
- * buffer will be set to the same value. If the module is currently updating the
- * LED chain, the function will fail and nothing will be set.
+ * buffer will be set to the same value. The function modifies the back buffer
+ * only. Hence, it may be called while the LED chain is updated. In palette
+ * mode, the pixel refers to the closest palette entry.
  * \param position The buffer position between 0 (inclusive) and
  * WS2801_CHAIN_SIZE (exclusive) or a value which indicates that all pixels
  * should be set to the same value.
  * \param red The value of the red channel.
  * \param green The value of the green channel.
  * \param blue The value of the blue channel.
- * \return The status of the operation. It will be successful if and only if
- * the value was set.
+ * \return The status of the operation.
  */
 status_t ws2801_setValue(uint8_t position, uint8_t red, uint8_t green,
 		uint8_t blue);
 
+/**
+ * \brief Sets the color of a range of pixels in the internal buffer.
+ * \details The function behaves like \ref ws2801_setValue but sets count
+ * consecutive pixels. Pixels at or beyond WS2801_CHAIN_SIZE are ignored.
+ * \param position The first pixel of the range
+ * \param count The number of pixels to set
+ * \param red The value of the red channel.
+ * \param green The value of the green channel.
+ * \param blue The value of the blue channel.
+ * \return The status of the operation.
+ */
+status_t ws2801_fillValues(uint8_t position, uint8_t count, uint8_t red,
+		uint8_t green, uint8_t blue);
+
+#ifdef USE_WS2801_PALETTE
+/**
+ * \brief Sets the color of a palette entry in the internal buffer.
+ * \details Every pixel which refers to the entry changes its color with the
+ * next update.
+ * \param index The palette index between 0 (inclusive) and WS2801_PALETTE_SIZE
+ * (exclusive)
+ * \param red The value of the red channel.
+ * \param green The value of the green channel.
+ * \param blue The value of the blue channel.
+ * \return The status of the operation.
+ */
+status_t ws2801_setPaletteEntry(uint8_t index, uint8_t red, uint8_t green,
+		uint8_t blue);
+#endif
+
+#ifdef USE_WS2801_GAMMA
+/**
+ * \brief Sets the global brightness in the internal buffer.
+ * \details The brightness scales every gamma corrected color value with the
+ * next update.
+ * \param brightness The brightness between 0 (off) and 255 (full brightness)
+ */
+void ws2801_setBrightness(uint8_t brightness);
+#endif
+
 /**
  * \brief Updates the status of the LEDs according to the internal buffer.
- * \details The function will update the values in a background task. If the
- * module is still busy with updating the last value, an error will be returned.
+ * \details The function will update the values in a background task. The back
+ * buffer becomes the transmitted front buffer and subsequent commands modify a
+ * copy of it. Only the prefix up to the last changed pixel is transmitted. If
+ * the module is still busy with updating the last value, the buffers will be
+ * swapped as soon as the previous image is latched.
  * \returns The status of the operation.
  */
 status_t ws2801_update(void);
@@ -0,0 +1,254 @@
+/**
+ * \file ws2801_animation.c
+ * \brief Implements the LED animation engine
+ * \details Each animation is driven by a 16 bit phase accumulator. The
+ * accumulator is increased by a fixed step once per frame such that it
+ * overflows once per period. Colors are interpolated in fixed point using the
+ * upper bits of the phase as weight.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ws2801_animation.h"
+
+#include "ws2801.h"
+
+#include <stdint.h>
+
+#ifndef F_CPU
+#warning "The CPU frequency F_CPU is not defined. Assume 8 MHz."
+#define F_CPU (8000000UL)
+#endif
+
+/**
+ * \brief The number of fast system timer ticks per frame
+ * \details The fast timer fires every 32768 CPU cycles. Hence, five ticks
+ * result in about 50 frames per second.
+ */
+#define WS2801_ANIMATION_FRAME_TICKS (5)
+
+/**
+ * \brief The phase increment per frame of an animation with a period of one
+ * millisecond.
+ * \details The phase overflows at 2^16. The step of a particular period is
+ * given by the quotient of the value and the period in milliseconds.
+ */
+#define WS2801_ANIMATION_PHASE_PER_MS \
+	((uint32_t) (WS2801_ANIMATION_FRAME_TICKS * 256ULL * 128ULL * 65536ULL \
+			* 1000ULL / F_CPU))
+
+/** \brief The currently running animation */
+static ws2801_animation_mode_t ws2801_animation_mode;
+
+/** \brief The number of fast ticks since the last frame */
+static uint8_t ws2801_animation_ticks;
+
+/** \brief The current phase of the animation */
+static uint16_t ws2801_animation_phase;
+
+/** \brief The phase increment per frame */
+static uint16_t ws2801_animation_step;
+
+/** \brief The primary color of the animation */
+static ws2801_animation_color_t ws2801_animation_primary;
+
+/** \brief The secondary color of the animation */
+static ws2801_animation_color_t ws2801_animation_secondary;
+
+/**
+ * \brief The last color which was set to every pixel
+ * \details The color is the starting point of the fade animation.
+ */
+static ws2801_animation_color_t ws2801_animation_last;
+
+static void ws2801_animation_render(uint16_t phase);
+static void ws2801_animation_setAll(const ws2801_animation_color_t *color);
+static uint8_t ws2801_animation_mixChannel(uint8_t from, uint8_t to,
+		uint16_t weight);
+static void ws2801_animation_mix(ws2801_animation_color_t *result,
+		const ws2801_animation_color_t *from,
+		const ws2801_animation_color_t *to, uint16_t weight);
+
+void ws2801_animation_init(void) {
+	ws2801_animation_mode = WS2801_ANIMATION_NONE;
+	ws2801_animation_last.red = 0;
+	ws2801_animation_last.green = 0;
+	ws2801_animation_last.blue = 0;
+}
+
+status_t ws2801_animation_start(uint8_t mode, uint16_t period,
+		const ws2801_animation_color_t *primary,
+		const ws2801_animation_color_t *secondary) {
+	uint32_t step;
+
+	if (mode > WS2801_ANIMATION_CHASE) {
+		return err_indexOutOfBounds;
+	}
+
+	step = (period == 0 ? UINT16_MAX : WS2801_ANIMATION_PHASE_PER_MS / period);
+	ws2801_animation_step = (step > UINT16_MAX ? UINT16_MAX : step);
+	if (ws2801_animation_step == 0) {
+		ws2801_animation_step = 1;
+	}
+
+	ws2801_animation_primary = *primary;
+	ws2801_animation_secondary = *secondary;
+	if (mode == WS2801_ANIMATION_FADE) {
+		// Fade from the last color
+		ws2801_animation_secondary = ws2801_animation_last;
+	}
+
+	ws2801_animation_phase = 0;
+	// Render the first frame with the next tick
+	ws2801_animation_ticks = WS2801_ANIMATION_FRAME_TICKS - 1;
+	ws2801_animation_mode = mode;
+
+	return success;
+}
+
+void ws2801_animation_stop(void) {
+	ws2801_animation_mode = WS2801_ANIMATION_NONE;
+}
+
+void ws2801_animation_timedFastTick(void) {
+	uint16_t phase;
+
+	if (ws2801_animation_mode == WS2801_ANIMATION_NONE) {
+		return;
+	}
+
+	ws2801_animation_ticks++;
+	if (ws2801_animation_ticks < WS2801_ANIMATION_FRAME_TICKS) {
+		return;
+	}
+	ws2801_animation_ticks = 0;
+
+	phase = ws2801_animation_phase;
+	ws2801_animation_phase += ws2801_animation_step;
+
+	if (ws2801_animation_mode == WS2801_ANIMATION_FADE
+			&& ws2801_animation_phase < phase) {
+		// The fade is finished, set the exact target color
+		ws2801_animation_setAll(&ws2801_animation_primary);
+		ws2801_animation_mode = WS2801_ANIMATION_NONE;
+	} else {
+		ws2801_animation_render(phase);
+	}
+
+	(void) ws2801_update();
+}
+
+/**
+ * \brief Renders a single frame of the current animation
+ * \param phase The current phase of the animation
+ */
+static void ws2801_animation_render(uint16_t phase) {
+	ws2801_animation_color_t color;
+	uint8_t i;
+
+	switch (ws2801_animation_mode) {
+	case WS2801_ANIMATION_FADE:
+		ws2801_animation_mix(&color, &ws2801_animation_secondary,
+				&ws2801_animation_primary, phase >> 8);
+		ws2801_animation_setAll(&color);
+		break;
+
+	case WS2801_ANIMATION_BREATHE:
+		// Triangular weight which rises in the first half of the period
+		ws2801_animation_mix(&color, &ws2801_animation_secondary,
+				&ws2801_animation_primary,
+				(phase < 0x8000 ? phase : UINT16_MAX - phase) >> 7);
+		ws2801_animation_setAll(&color);
+		break;
+
+	case WS2801_ANIMATION_BLINK:
+		ws2801_animation_setAll(
+				phase < 0x8000 ?
+						&ws2801_animation_primary : &ws2801_animation_secondary);
+		break;
+
+	case WS2801_ANIMATION_GRADIENT:
+		for (i = 0; i < WS2801_CHAIN_SIZE; i++) {
+#if WS2801_CHAIN_SIZE > 1
+			ws2801_animation_mix(&color, &ws2801_animation_primary,
+					&ws2801_animation_secondary,
+					(uint16_t) i * 256 / (WS2801_CHAIN_SIZE - 1));
+#else
+			color = ws2801_animation_primary;
+#endif
+			(void) ws2801_setValue(i, color.red, color.green, color.blue);
+		}
+		// The gradient is static
+		ws2801_animation_mode = WS2801_ANIMATION_NONE;
+		break;
+
+	case WS2801_ANIMATION_CHASE:
+		(void) ws2801_fillValues(0, WS2801_CHAIN_SIZE,
+				ws2801_animation_secondary.red,
+				ws2801_animation_secondary.green,
+				ws2801_animation_secondary.blue);
+		(void) ws2801_setValue(((phase >> 8) * WS2801_CHAIN_SIZE) >> 8,
+				ws2801_animation_primary.red, ws2801_animation_primary.green,
+				ws2801_animation_primary.blue);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/**
+ * \brief Sets every pixel to the given color and remembers it
+ * \param color The color to set
+ */
+static void ws2801_animation_setAll(const ws2801_animation_color_t *color) {
+	(void) ws2801_fillValues(0, WS2801_CHAIN_SIZE, color->red, color->green,
+			color->blue);
+	ws2801_animation_last = *color;
+}
+
+/**
+ * \brief Interpolates a single color channel
+ * \param from The value at weight zero
+ * \param to The value at weight 256
+ * \param weight The weight of the target value in 1/256 units
+ * \return The interpolated value
+ */
+static uint8_t ws2801_animation_mixChannel(uint8_t from, uint8_t to,
+		uint16_t weight) {
+	if (to >= from) {
+		return from + (((uint16_t) (to - from) * weight) >> 8);
+	} else {
+		return from - (((uint16_t) (from - to) * weight) >> 8);
+	}
+}
+
+/**
+ * \brief Interpolates two colors
+ * \param result Receives the interpolated color
+ * \param from The color at weight zero
+ * \param to The color at weight 256
+ * \param weight The weight of the target color in 1/256 units
+ */
+static void ws2801_animation_mix(ws2801_animation_color_t *result,
+		const ws2801_animation_color_t *from,
+		const ws2801_animation_color_t *to, uint16_t weight) {
+	result->red = ws2801_animation_mixChannel(from->red, to->red, weight);
+	result->green = ws2801_animation_mixChannel(from->green, to->green, weight);
+	result->blue = ws2801_animation_mixChannel(from->blue, to->blue, weight);
+}
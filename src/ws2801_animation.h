@@ -0,0 +1,95 @@
+/**
+ * \file ws2801_animation.h
+ * \brief Specifies the interface of the LED animation engine
+ * \details The module renders simple animations of the whole LED chain without
+ * any further interaction of the controller. Each animation is parameterized by
+ * a mode, a period and two colors. The engine writes the pixels via the
+ * \ref ws2801.h interface and triggers the update of the chain itself. Before
+ * any other function of the module can be used, \ref ws2801_init and
+ * \ref ws2801_animation_init have to be called.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef WS2801_ANIMATION_H_
+#define WS2801_ANIMATION_H_
+
+#include "error.h"
+
+#include <stdint.h>
+
+/**
+ * \brief Defines the available animations
+ * \details The numeric values are part of the network interface.
+ */
+typedef enum {
+	WS2801_ANIMATION_NONE = 0, ///< Stops the current animation
+	/** Fades every pixel from the last color to the primary color once */
+	WS2801_ANIMATION_FADE = 1,
+	/** Fades between the secondary and the primary color back and forth */
+	WS2801_ANIMATION_BREATHE = 2,
+	/** Switches between the primary and the secondary color */
+	WS2801_ANIMATION_BLINK = 3,
+	/** Shows a static gradient from the primary to the secondary color */
+	WS2801_ANIMATION_GRADIENT = 4,
+	/** Moves a primary colored pixel over the secondary colored chain */
+	WS2801_ANIMATION_CHASE = 5
+} ws2801_animation_mode_t;
+
+/** \brief Holds a single color */
+typedef struct {
+	uint8_t red; ///< The value of the red channel
+	uint8_t green; ///< The value of the green channel
+	uint8_t blue; ///< The value of the blue channel
+} ws2801_animation_color_t;
+
+/**
+ * \brief Initializes the module
+ * \details The function has to be called before any other function of the
+ * module is called. Initially, no animation is running.
+ */
+void ws2801_animation_init(void);
+
+/**
+ * \brief Advances the current animation
+ * \details The function has to be called whenever the fast system timer fires.
+ */
+void ws2801_animation_timedFastTick(void);
+
+/**
+ * \brief Starts a new animation
+ * \details Any running animation is replaced. The period denotes the duration
+ * of the fade, of a single breathe or blink cycle and of a single pass of the
+ * chase animation. It is ignored by the gradient.
+ * \param mode The animation to start
+ * \param period The period of the animation in milliseconds
+ * \param primary The primary color
+ * \param secondary The secondary color
+ * \return The status of the operation. err_indexOutOfBounds indicates an
+ * unknown mode.
+ */
+status_t ws2801_animation_start(uint8_t mode, uint16_t period,
+		const ws2801_animation_color_t *primary,
+		const ws2801_animation_color_t *secondary);
+
+/**
+ * \brief Stops the current animation
+ * \details The LED chain keeps its current color.
+ */
+void ws2801_animation_stop(void);
+
+#endif /* WS2801_ANIMATION_H_ */
@@ -0,0 +1,72 @@
+/**
+ * \file bench.h
+ * \brief Provides the time measurement of the host benchmarks
+ * \details The benchmarks run single modules on the host. Hence, the absolute
+ * figures depend on the host and only the ratio between two variants of the
+ * same benchmark is meaningful. Each variant is repeated until it ran for a
+ * fixed amount of time. The result is printed as a single line per variant.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+/** \brief The minimal duration of each variant in seconds */
+#define BENCH_DURATION (0.2)
+
+/** \brief The number of iterations between two clock readings */
+#define BENCH_BATCH (4096UL)
+
+/**
+ * \brief Returns a monotonic time stamp
+ * \return The time stamp in seconds
+ */
+static inline double bench_now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * \brief Measures a single variant
+ * \details The statement is executed in batches of \ref BENCH_BATCH
+ * iterations. The loop variable <code>bench_i</code> may be used to vary the
+ * input. The resulting time per iteration is stored in the given variable.
+ * \param nsPerIteration The double variable which receives the result in
+ * nanoseconds per iteration
+ * \param statement The statement to measure
+ */
+#define BENCH_MEASURE(nsPerIteration, statement) do { \
+		unsigned long bench_count = 0, bench_i; \
+		double bench_start = bench_now(), bench_elapsed; \
+		do { \
+			for (bench_i = 0; bench_i < BENCH_BATCH; bench_i++) { \
+				statement; \
+			} \
+			bench_count += BENCH_BATCH; \
+			bench_elapsed = bench_now() - bench_start; \
+		} while (bench_elapsed < BENCH_DURATION); \
+		(nsPerIteration) = bench_elapsed * 1e9 / bench_count; \
+	} while (0)
+
+#endif /* BENCH_H_ */
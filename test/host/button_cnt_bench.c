@@ -0,0 +1,193 @@
+/**
+ * \file button_cnt_bench.c
+ * \brief Compares the vertical counter debouncing against the original loop
+ * \details The original debouncing kept a shift register per button and
+ * extracted each pin separately. Its fast tick is copied verbatim and
+ * measured for three and for eight buttons. The new debouncing is measured by
+ * calling the fast tick of the module. The inputs either stay released, which
+ * is the common case, or bounce randomly. Both variants are fed with the same
+ * bouncing input sequence and the detected presses are compared to the actual
+ * presses. The bouncing figures of the module include the callback and the
+ * event queue.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "bench.h"
+
+#include "button_cnt.h"
+
+#include <avr/io.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** \brief The number of samples of the input sequence */
+#define BENCH_SEQUENCE_SIZE (4096)
+
+/** \brief The minimal number of stable samples between two edges */
+#define BENCH_STABLE_SAMPLES (8)
+
+/** \brief The number of samples which the original loop waits */
+#define BENCH_WAIT_SAMPLES (3)
+
+volatile uint8_t stub_io[0x40];
+
+void stub_waitBit(volatile uint8_t *sfr, uint8_t bit) {
+}
+
+/** \brief The sampled pin states of a bouncing input */
+static uint8_t bench_sequence[BENCH_SEQUENCE_SIZE];
+
+/** \brief The number of presses in the input sequence */
+static unsigned long bench_actual;
+
+/** \brief The number of presses which were reported by the module */
+static unsigned long bench_presses;
+
+/** \brief The shift registers of the original loop */
+static uint8_t bench_states[8];
+
+/** \brief Keeps the results alive */
+static volatile uint8_t bench_sink;
+
+/**
+ * \brief Counts the presses which are reported by the module
+ * \param cnt The counter value
+ * \param btn The pressed buttons
+ */
+static void bench_callback(int16_t cnt, uint8_t btn) {
+	uint8_t i;
+
+	for (i = 0; i < 8; i++) {
+		bench_presses += (btn >> i) & 0x01;
+	}
+}
+
+/**
+ * \brief The fast tick of the original loop
+ * \details The body is a verbatim copy of the original implementation with
+ * the number of buttons as parameter.
+ * \param channels The number of buttons
+ * \return A bit mask of the pressed buttons
+ */
+static __attribute__((noinline)) uint8_t bench_originalTick(uint8_t channels) {
+	uint8_t i;
+	uint8_t pressed = 0;
+	uint8_t maskedValue;
+
+	for (i = 0; i < channels; i++) {
+		// Shift the first bit into the state
+		bench_states[i] <<= 1;
+		bench_states[i] |= (PINC >> (PINC0 + i)) & 0x01;
+		// Mask the first WAIT_SAMPLES + 1 bits
+		maskedValue = bench_states[i] & ((1 << (BENCH_WAIT_SAMPLES + 1)) - 1);
+		// Check if the masked value equals 10...0
+		pressed |= (maskedValue == (1 << BENCH_WAIT_SAMPLES)) << i;
+	}
+	return pressed;
+}
+
+/**
+ * \brief Generates a random input sequence of bouncing buttons
+ * \details Each button is pressed and released repeatedly. Each edge bounces
+ * for a few samples and is followed by at least \ref BENCH_STABLE_SAMPLES
+ * stable samples. The inputs are pulled up, i.e. a pressed button reads zero.
+ */
+static void bench_generate(void) {
+	uint32_t random = 1;
+	uint8_t level = 0xFF, bounce = 0, stable = 0;
+	unsigned i;
+
+	for (i = 0; i < BENCH_SEQUENCE_SIZE; i++) {
+		random = random * 1103515245UL + 12345;
+		if (bounce > 0) {
+			bench_sequence[i] = level ^ ((random >> 16) & 0xFF);
+			bounce--;
+		} else {
+			if (stable >= BENCH_STABLE_SAMPLES && ((random >> 16) & 0x3F) == 0) {
+				stable = 0;
+				level = ~level;
+				bounce = (random >> 24) & 0x07;
+				bench_actual += (level == 0) * 3;
+			}
+			bench_sequence[i] = level;
+			if (stable < BENCH_STABLE_SAMPLES) {
+				stable++;
+			}
+		}
+	}
+}
+
+/**
+ * \brief Counts the presses which both variants detect in the input sequence
+ */
+static void bench_compare(void) {
+	unsigned long original = 0;
+	uint8_t pressed;
+	unsigned i, k;
+
+	for (i = 0; i < 8; i++) {
+		bench_states[i] = 0;
+	}
+	button_cnt_init(bench_callback);
+	bench_presses = 0;
+	for (i = 0; i < BENCH_SEQUENCE_SIZE; i++) {
+		PINC = bench_sequence[i];
+		pressed = bench_originalTick(3);
+		for (k = 0; k < 3; k++) {
+			original += (pressed >> k) & 0x01;
+		}
+		button_cnt_timedFastTick();
+	}
+	printf("presses in %u bouncing samples of 3 buttons: actual %lu, "
+			"original %lu, vertical counter %lu\n", BENCH_SEQUENCE_SIZE,
+			bench_actual, original, bench_presses);
+}
+
+int main(void) {
+	double ns;
+
+	bench_generate();
+	bench_compare();
+
+	printf("Host time per fast tick\n");
+	PINC = 0xFF;
+	BENCH_MEASURE(ns, bench_sink = bench_originalTick(3));
+	printf("%-36s %6.2f ns\n", "original loop, 3 buttons", ns);
+	BENCH_MEASURE(ns, bench_sink = bench_originalTick(8));
+	printf("%-36s %6.2f ns\n", "original loop, 8 buttons", ns);
+	button_cnt_init(bench_callback);
+	BENCH_MEASURE(ns, button_cnt_timedFastTick());
+	printf("%-36s %6.2f ns\n", "vertical counter, released", ns);
+
+	BENCH_MEASURE(ns,
+		PINC = bench_sequence[bench_i % BENCH_SEQUENCE_SIZE];
+		bench_sink = bench_originalTick(3));
+	printf("%-36s %6.2f ns\n", "original loop, 3 bouncing buttons", ns);
+	BENCH_MEASURE(ns,
+		PINC = bench_sequence[bench_i % BENCH_SEQUENCE_SIZE];
+		bench_sink = bench_originalTick(8));
+	printf("%-36s %6.2f ns\n", "original loop, 8 bouncing buttons", ns);
+	button_cnt_init(bench_callback);
+	BENCH_MEASURE(ns,
+		PINC = bench_sequence[bench_i % BENCH_SEQUENCE_SIZE];
+		button_cnt_timedFastTick();
+		while (button_cnt_popEvent(&(button_cnt_event_t) { 0 })));
+	printf("%-36s %6.2f ns\n", "vertical counter, 3 bouncing buttons", ns);
+	return 0;
+}
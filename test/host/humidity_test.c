@@ -0,0 +1,164 @@
+/**
+ * \file humidity_test.c
+ * \brief Compares the fixed point humidity computation against the Magnus
+ * formula
+ * \details The dew point and the absolute humidity are computed for every
+ * supported temperature and every relative humidity from 0.1 to 100 percent
+ * in steps of 0.1. The reference values are computed in double precision from
+ * the Magnus formula which the saturation table is based on. The dew point
+ * has to be within 0.15 degree Celsius. The absolute humidity has to be within
+ * 0.5 percent plus one unit of the result, i.e. 0.01 g/m^3.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "test.h"
+
+#include "humidity.h"
+
+#include <math.h>
+#include <stdint.h>
+
+/** \brief The maximal error of the dew point in degree Celsius */
+#define TEST_DEW_POINT_TOLERANCE (0.15)
+/** \brief The maximal relative error of the absolute humidity */
+#define TEST_ABS_HUMIDITY_TOLERANCE (0.005)
+/** \brief The resolution of the absolute humidity in g/m^3 */
+#define TEST_ABS_HUMIDITY_UNIT (0.01)
+
+/**
+ * \brief Returns the saturation vapour pressure over water
+ * \param t The temperature in degree Celsius
+ * \return The pressure in Pa
+ */
+static double test_saturation(double t) {
+	return 611.2 * exp(17.62 * t / (243.12 + t));
+}
+
+/**
+ * \brief Returns the reference dew point
+ * \details Dew points below the supported range are reported as the lowest
+ * supported temperature.
+ * \param t The temperature in degree Celsius
+ * \param rh The relative humidity in percent
+ * \return The dew point in degree Celsius
+ */
+static double test_dewPoint(double t, double rh) {
+	double g = log(rh / 100.0) + 17.62 * t / (243.12 + t);
+	double dewPoint = 243.12 * g / (17.62 - g);
+
+	return fmax(dewPoint, HUMIDITY_MIN_TEMPERATURE / 10.0);
+}
+
+/**
+ * \brief Returns the reference absolute humidity
+ * \param t The temperature in degree Celsius
+ * \param rh The relative humidity in percent
+ * \return The absolute humidity in g/m^3
+ */
+static double test_absHumidity(double t, double rh) {
+	return test_saturation(t) * rh / 100.0 * 1000.0 / 461.5 / (t + 273.15);
+}
+
+/** \brief Compares every supported input against the reference */
+static void test_accuracy(void) {
+	int16_t temperature, relHumidity, dewPoint, absHumidity;
+	double t, rh, error, ref;
+	double worstDewPoint = 0, worstAbsHumidity = 0;
+	int16_t dewPointAt[2] = { 0, 0 }, absHumidityAt[2] = { 0, 0 };
+	unsigned long failed = 0;
+
+	for (temperature = HUMIDITY_MIN_TEMPERATURE;
+			temperature <= HUMIDITY_MAX_TEMPERATURE; temperature++) {
+		for (relHumidity = 1; relHumidity <= 1000; relHumidity++) {
+			if (humidity_compute(temperature, relHumidity, &dewPoint,
+					&absHumidity) != success) {
+				failed++;
+				continue;
+			}
+			t = temperature / 10.0;
+			rh = relHumidity / 10.0;
+
+			error = fabs(dewPoint / 10.0 - test_dewPoint(t, rh));
+			if (error > worstDewPoint) {
+				worstDewPoint = error;
+				dewPointAt[0] = temperature;
+				dewPointAt[1] = relHumidity;
+			}
+
+			// The rounding of the result is accounted for by a single unit
+			ref = test_absHumidity(t, rh);
+			error = (fabs(absHumidity / 100.0 - ref) - TEST_ABS_HUMIDITY_UNIT)
+					/ ref;
+			if (error > worstAbsHumidity) {
+				worstAbsHumidity = error;
+				absHumidityAt[0] = temperature;
+				absHumidityAt[1] = relHumidity;
+			}
+		}
+	}
+
+	printf("dew point: worst error %.3f C at %d/10 C, %d/10 %%\n",
+			worstDewPoint, dewPointAt[0], dewPointAt[1]);
+	printf("absolute humidity: worst error %.3f %% + 0.01 g/m^3 at %d/10 C, "
+			"%d/10 %%\n", worstAbsHumidity * 100, absHumidityAt[0],
+			absHumidityAt[1]);
+	TEST_ASSERT_EQUAL(0, failed);
+	TEST_ASSERT(worstDewPoint <= TEST_DEW_POINT_TOLERANCE);
+	TEST_ASSERT(worstAbsHumidity <= TEST_ABS_HUMIDITY_TOLERANCE);
+}
+
+/** \brief Checks the handling of inputs outside the supported range */
+static void test_bounds(void) {
+	int16_t dewPoint = 1, absHumidity = 2;
+	int16_t saturatedDewPoint, saturatedAbsHumidity;
+
+	TEST_ASSERT_EQUAL(err_indexOutOfBounds,
+			humidity_compute(HUMIDITY_MIN_TEMPERATURE - 1, 500, &dewPoint,
+					&absHumidity));
+	TEST_ASSERT_EQUAL(err_indexOutOfBounds,
+			humidity_compute(HUMIDITY_MAX_TEMPERATURE + 1, 500, &dewPoint,
+					&absHumidity));
+	TEST_ASSERT_EQUAL(err_indexOutOfBounds,
+			humidity_compute(200, 0, &dewPoint, &absHumidity));
+	TEST_ASSERT_EQUAL(err_indexOutOfBounds,
+			humidity_compute(200, -10, &dewPoint, &absHumidity));
+	TEST_ASSERT_EQUAL(1, dewPoint);
+	TEST_ASSERT_EQUAL(2, absHumidity);
+
+	// A relative humidity above 100 percent is treated as saturation
+	TEST_ASSERT_EQUAL(success,
+			humidity_compute(200, 1000, &saturatedDewPoint,
+					&saturatedAbsHumidity));
+	TEST_ASSERT_EQUAL(200, saturatedDewPoint);
+	TEST_ASSERT_EQUAL(success,
+			humidity_compute(200, 1200, &dewPoint, &absHumidity));
+	TEST_ASSERT_EQUAL(200, dewPoint);
+	TEST_ASSERT_EQUAL(saturatedAbsHumidity, absHumidity);
+
+	// The dew point is clipped at the lowest supported temperature
+	TEST_ASSERT_EQUAL(success,
+			humidity_compute(-300, 10, &dewPoint, &absHumidity));
+	TEST_ASSERT_EQUAL(HUMIDITY_MIN_TEMPERATURE, dewPoint);
+}
+
+int main(void) {
+	test_accuracy();
+	test_bounds();
+	return test_report("humidity");
+}
@@ -0,0 +1,196 @@
+/**
+ * \file iec61499_com_bench.c
+ * \brief Measures the encoding throughput of the IEC 61499 codec
+ * \details The benchmark reports the encoded bytes per second of every
+ * supported type. The hand-written INT encoder of the original codec serves as
+ * baseline. The reply path is measured as well: the original reply encoded
+ * six INT values per message whereas the pre-encoded template only patches
+ * the values and copies the selected fields.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "bench.h"
+
+#include "iec61499_com.h"
+#include "esp8266_receiver.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+/** \brief The size of the destination buffer */
+#define BENCH_BUFFER_SIZE (64)
+
+/** \brief The destination of every encoder */
+static uint8_t bench_buffer[BENCH_BUFFER_SIZE];
+
+/** \brief Keeps the results alive */
+static volatile uint8_t bench_sink;
+
+uint8_t esp8266_receiver_getByte(uint8_t rrbID, uint8_t offset) {
+	return 0;
+}
+
+/**
+ * \brief The INT encoder of the original codec
+ * \details The function is a verbatim copy of the baseline implementation. It
+ * isn't inlined such that it is called like the library functions.
+ */
+static __attribute__((noinline)) void bench_baselineEncodeINT(
+		uint8_t *buffer, uint8_t size, uint8_t *nextIndex, int16_t value) {
+
+	if ((*nextIndex) + IEC61499_COM_INT_ENC_SIZE <= size) {
+		buffer[*nextIndex] = IEC61499_COM_CLASS_APPLICATION | IEC61499_COM_TAG_INT;
+		buffer[*nextIndex + 1] = (value >> 8) & 0xFF;
+		buffer[*nextIndex + 2] = value & 0xFF;
+	}
+
+	*nextIndex += IEC61499_COM_INT_ENC_SIZE;
+
+}
+
+/**
+ * \brief Prints the result of a single variant
+ * \param name The name of the variant
+ * \param ns The time per iteration in nanoseconds
+ * \param bytes The number of encoded bytes per iteration
+ * \param baseline The time per byte of the baseline or zero
+ */
+static void bench_print(const char *name, double ns, unsigned bytes,
+		double baseline) {
+	double perByte = ns / bytes;
+
+	if (baseline > 0) {
+		printf("%-24s %7.2f ns/op %8.1f MB/s %6.2fx baseline\n", name, ns,
+				1e3 / perByte, baseline / perByte);
+	} else {
+		printf("%-24s %7.2f ns/op %8.1f MB/s\n", name, ns, 1e3 / perByte);
+	}
+	bench_sink = bench_buffer[0];
+}
+
+/**
+ * \brief Measures the encoder of a fixed size type
+ * \details The buffer is refilled from the start as soon as the next value
+ * doesn't fit anymore.
+ * \param type The IEC 61499 type name
+ * \param value The expression which gives the value of iteration bench_i
+ */
+#define BENCH_ENCODER(type, value) do { \
+		uint8_t nextIndex = 0; \
+		double ns; \
+		BENCH_MEASURE(ns, \
+			if (nextIndex > BENCH_BUFFER_SIZE - IEC61499_COM_##type##_ENC_SIZE) { \
+				nextIndex = 0; \
+			} \
+			iec61499_com_encode##type(bench_buffer, BENCH_BUFFER_SIZE, &nextIndex, \
+					(value))); \
+		bench_print(#type, ns, IEC61499_COM_##type##_ENC_SIZE, baseline); \
+	} while (0)
+
+/** \brief The layout of the reply which is used by the reply path benchmark */
+#define BENCH_REPLY(FIELD) \
+	FIELD(temperatureChn0, INT) \
+	FIELD(humidityChn0, INT) \
+	FIELD(temperatureChn1, INT) \
+	FIELD(humidityChn1, INT) \
+	FIELD(buttonCnt, INT) \
+	FIELD(buttonFlags, INT)
+
+IEC61499_COM_DECLARE_FRAME(bench_reply, BENCH_REPLY)
+
+/** \brief Measures the encoding of the whole reply message */
+static void bench_reply(void) {
+	static const uint8_t sizes[] = IEC61499_COM_FRAME_SIZES(BENCH_REPLY);
+	static bench_reply_enc_t reply = IEC61499_COM_FRAME_INIT(BENCH_REPLY);
+	uint8_t nextIndex, i;
+	double ns, baseline;
+
+	BENCH_MEASURE(baseline,
+		nextIndex = 0;
+		for (i = 0; i < 6; i++) {
+			bench_baselineEncodeINT(bench_buffer, BENCH_BUFFER_SIZE, &nextIndex,
+					(int16_t) (bench_i + i));
+		});
+	bench_print("reply: encode 6 INT", baseline, sizeof(reply), 0);
+	baseline /= sizeof(reply);
+
+	BENCH_MEASURE(ns, iec61499_com_updateINT(reply.temperatureChn0,
+			(int16_t) bench_i));
+	bench_print("reply: patch 1 value", ns, sizeof(reply), baseline);
+
+	BENCH_MEASURE(ns,
+		for (i = 0; i < 6; i++) {
+			iec61499_com_updateINT((uint8_t *) &reply + i * IEC61499_COM_INT_ENC_SIZE,
+					(int16_t) (bench_i + i));
+		});
+	bench_print("reply: patch 6 values", ns, sizeof(reply), baseline);
+
+	BENCH_MEASURE(ns, bench_sink += iec61499_com_projectFrame(bench_buffer,
+			&reply, sizes, 6, 0x0F ^ (bench_i & 1)));
+	bench_print("reply: project 4 fields", ns, sizeof(reply), baseline);
+}
+
+int main(void) {
+	static const char string[] = "WiFiRoom";
+	uint32_t array[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	uint8_t nextIndex, i;
+	double ns, baseline;
+
+	printf("Encoded bytes per second of each type (host figures)\n");
+
+	// The first pass warms up the host and isn't reported
+	for (i = 0; i < 2; i++) {
+		nextIndex = 0;
+		BENCH_MEASURE(baseline,
+			if (nextIndex > BENCH_BUFFER_SIZE - IEC61499_COM_INT_ENC_SIZE) {
+				nextIndex = 0;
+			}
+			bench_baselineEncodeINT(bench_buffer, BENCH_BUFFER_SIZE, &nextIndex,
+					(int16_t) bench_i));
+	}
+	bench_print("INT (baseline)", baseline, IEC61499_COM_INT_ENC_SIZE, 0);
+	baseline /= IEC61499_COM_INT_ENC_SIZE;
+
+	BENCH_ENCODER(BOOL, bench_i & 1);
+	BENCH_ENCODER(SINT, (int8_t) bench_i);
+	BENCH_ENCODER(INT, (int16_t) bench_i);
+	BENCH_ENCODER(DINT, (int32_t) bench_i);
+	BENCH_ENCODER(USINT, (uint8_t) bench_i);
+	BENCH_ENCODER(UINT, (uint16_t) bench_i);
+	BENCH_ENCODER(UDINT, (uint32_t) bench_i);
+	BENCH_ENCODER(REAL, (float) bench_i);
+	BENCH_ENCODER(TIME, (int32_t) bench_i);
+
+	BENCH_MEASURE(ns,
+		nextIndex = 0;
+		iec61499_com_encodeSTRING(bench_buffer, BENCH_BUFFER_SIZE, &nextIndex,
+				string, sizeof(string) - 1));
+	bench_print("STRING[8]", ns, IEC61499_COM_STRING_ENC_SIZE(8), baseline);
+
+	BENCH_MEASURE(ns,
+		nextIndex = 0;
+		array[0] = bench_i;
+		iec61499_com_encodeARRAY(bench_buffer, BENCH_BUFFER_SIZE, &nextIndex,
+				IEC61499_COM_TAG_UDINT, array, 8));
+	bench_print("ARRAY[8] OF UDINT", ns, IEC61499_COM_ARRAY_ENC_SIZE(UDINT, 8),
+			baseline);
+
+	bench_reply();
+	return 0;
+}
@@ -0,0 +1,340 @@
+/**
+ * \file iec61499_com_test.c
+ * \brief Round trips every supported type through the IEC 61499 codec
+ * \details Each value is encoded and compared against the byte sequence which
+ * the FBDK and 4DIAC FORTE send for it, i.e. the ASN.1 encoding of the
+ * informative annex of the IEC 61499-1. The same sequence is decoded from a
+ * simulated receive buffer which wraps in the middle of the message. The
+ * decoded value has to equal the encoded one. Truncated messages and invalid
+ * tags have to be rejected without advancing the index.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "test.h"
+
+#include "iec61499_com.h"
+#include "esp8266_receiver.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/** \brief The simulated round robin buffer of the receiver */
+static uint8_t test_ring[256];
+
+uint8_t esp8266_receiver_getByte(uint8_t rrbID, uint8_t offset) {
+	return test_ring[(uint8_t) (rrbID + offset)];
+}
+
+/**
+ * \brief Places a message into the receive buffer
+ * \details The message is placed such that it wraps at the end of the buffer.
+ * \param msg The received bytes
+ * \param size The number of received bytes
+ * \return The round robin buffer id of the first byte
+ */
+static uint8_t test_receive(const uint8_t *msg, uint8_t size) {
+	uint8_t rrbID = (uint8_t) (0 - size / 2);
+	uint8_t i;
+
+	for (i = 0; i < size; i++) {
+		test_ring[(uint8_t) (rrbID + i)] = msg[i];
+	}
+	return rrbID;
+}
+
+/**
+ * \brief Round trips a value of a fixed size type
+ * \details The encoding is compared against the expected bytes which are given
+ * as variable arguments. The value is decoded by the checked decoder and by
+ * the unchecked read function.
+ * \param type The IEC 61499 type name
+ * \param ctype The native type of the value
+ * \param value The value to encode
+ */
+#define TEST_ROUND_TRIP(type, ctype, value, ...) do { \
+		static const uint8_t expected[] = { __VA_ARGS__ }; \
+		uint8_t buffer[sizeof(expected) + 1]; \
+		uint8_t nextIndex = 0; \
+		uint8_t rrbID; \
+		ctype decoded = 0; \
+		memset(buffer, 0xA5, sizeof(buffer)); \
+		TEST_ASSERT_EQUAL(IEC61499_COM_##type##_ENC_SIZE, sizeof(expected)); \
+		iec61499_com_encode##type(buffer, sizeof(buffer), &nextIndex, (value)); \
+		TEST_ASSERT_EQUAL(sizeof(expected), nextIndex); \
+		TEST_ASSERT_BYTES(expected, buffer, sizeof(expected)); \
+		TEST_ASSERT_EQUAL(0xA5, buffer[sizeof(expected)]); \
+		rrbID = test_receive(expected, sizeof(expected)); \
+		nextIndex = 0; \
+		TEST_ASSERT_EQUAL(success, iec61499_com_decode##type(rrbID, \
+				sizeof(expected), &nextIndex, &decoded)); \
+		TEST_ASSERT_EQUAL(sizeof(expected), nextIndex); \
+		TEST_ASSERT(decoded == (ctype) (value)); \
+		decoded = 0; \
+		TEST_ASSERT_EQUAL(success, iec61499_com_read##type(rrbID, 0, &decoded)); \
+		TEST_ASSERT(decoded == (ctype) (value)); \
+		nextIndex = 0; \
+		TEST_ASSERT_EQUAL(err_indexOutOfBounds, iec61499_com_decode##type(rrbID, \
+				sizeof(expected) - 1, &nextIndex, &decoded)); \
+		TEST_ASSERT_EQUAL(0, nextIndex); \
+	} while (0)
+
+/** \brief Tests every fixed size type */
+static void test_fixedSize(void) {
+	TEST_ROUND_TRIP(SINT, int8_t, -2, 0x42, 0xFE);
+	TEST_ROUND_TRIP(SINT, int8_t, 127, 0x42, 0x7F);
+	TEST_ROUND_TRIP(INT, int16_t, 1234, 0x43, 0x04, 0xD2);
+	TEST_ROUND_TRIP(INT, int16_t, -32768, 0x43, 0x80, 0x00);
+	TEST_ROUND_TRIP(DINT, int32_t, -100000, 0x44, 0xFF, 0xFE, 0x79, 0x60);
+	TEST_ROUND_TRIP(USINT, uint8_t, 200, 0x46, 0xC8);
+	TEST_ROUND_TRIP(UINT, uint16_t, 65535, 0x47, 0xFF, 0xFF);
+	TEST_ROUND_TRIP(UINT, uint16_t, 0x0102, 0x47, 0x01, 0x02);
+	TEST_ROUND_TRIP(UDINT, uint32_t, 0x12345678UL, 0x48, 0x12, 0x34, 0x56,
+			0x78);
+	TEST_ROUND_TRIP(UDINT, uint32_t, 0xFFFFFFFFUL, 0x48, 0xFF, 0xFF, 0xFF,
+			0xFF);
+	TEST_ROUND_TRIP(REAL, float, 1.5f, 0x4A, 0x3F, 0xC0, 0x00, 0x00);
+	TEST_ROUND_TRIP(REAL, float, -21.25f, 0x4A, 0xC1, 0xAA, 0x00, 0x00);
+	TEST_ROUND_TRIP(TIME, int32_t, 1000, 0x4C, 0x00, 0x00, 0x00, 0x00, 0x00,
+			0x00, 0x03, 0xE8);
+	TEST_ROUND_TRIP(TIME, int32_t, -1, 0x4C, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+			0xFF, 0xFF);
+}
+
+/** \brief Tests the encoding of BOOL values and the tag checks */
+static void test_bool(void) {
+	static const uint8_t expected[] = { 0x41, 0x40 };
+	uint8_t buffer[2];
+	uint8_t nextIndex = 0;
+	uint8_t rrbID, value = 0x55;
+
+	iec61499_com_encodeBOOL(buffer, sizeof(buffer), &nextIndex, 7);
+	iec61499_com_encodeBOOL(buffer, sizeof(buffer), &nextIndex, 0);
+	TEST_ASSERT_EQUAL(2, nextIndex);
+	TEST_ASSERT_BYTES(expected, buffer, sizeof(expected));
+
+	rrbID = test_receive(expected, sizeof(expected));
+	nextIndex = 0;
+	TEST_ASSERT_EQUAL(success,
+			iec61499_com_decodeBOOL(rrbID, sizeof(expected), &nextIndex, &value));
+	TEST_ASSERT(value != 0);
+	TEST_ASSERT_EQUAL(success,
+			iec61499_com_decodeBOOL(rrbID, sizeof(expected), &nextIndex, &value));
+	TEST_ASSERT_EQUAL(0, value);
+	TEST_ASSERT_EQUAL(2, nextIndex);
+	TEST_ASSERT_EQUAL(err_indexOutOfBounds,
+			iec61499_com_decodeBOOL(rrbID, sizeof(expected), &nextIndex, &value));
+}
+
+/** \brief Tests that invalid tags and small buffers are handled */
+static void test_errors(void) {
+	static const uint8_t uintValue[] = { 0x47, 0x00, 0x01 };
+	uint8_t buffer[4] = { 0xA5, 0xA5, 0xA5, 0xA5 };
+	uint8_t nextIndex = 2;
+	uint8_t rrbID;
+	int16_t value = 0x55;
+
+	// The encoder skips values which don't fit but advances the index
+	iec61499_com_encodeINT(buffer, sizeof(buffer), &nextIndex, 1);
+	TEST_ASSERT_EQUAL(5, nextIndex);
+	TEST_ASSERT_EQUAL(0xA5, buffer[2]);
+	TEST_ASSERT_EQUAL(0xA5, buffer[3]);
+
+	// A UINT isn't accepted as INT
+	rrbID = test_receive(uintValue, sizeof(uintValue));
+	nextIndex = 0;
+	TEST_ASSERT_EQUAL(err_invalidMagicNumber,
+			iec61499_com_decodeINT(rrbID, sizeof(uintValue), &nextIndex, &value));
+	TEST_ASSERT_EQUAL(0, nextIndex);
+	TEST_ASSERT_EQUAL(0x55, value);
+}
+
+/** \brief Tests the encoding of STRING values */
+static void test_string(void) {
+	static const uint8_t expected[] = { 0x50, 0x00, 0x04, 'W', 'i', 'F', 'i' };
+	static const uint8_t empty[] = { 0x50, 0x00, 0x00 };
+	uint8_t buffer[sizeof(expected)];
+	char value[8];
+	uint8_t nextIndex = 0;
+	uint8_t rrbID, length = 0;
+
+	iec61499_com_encodeSTRING(buffer, sizeof(buffer), &nextIndex, "WiFi", 4);
+	TEST_ASSERT_EQUAL(sizeof(expected), nextIndex);
+	TEST_ASSERT_BYTES(expected, buffer, sizeof(expected));
+
+	rrbID = test_receive(expected, sizeof(expected));
+	nextIndex = 0;
+	TEST_ASSERT_EQUAL(success, iec61499_com_decodeSTRING(rrbID,
+			sizeof(expected), &nextIndex, value, sizeof(value), &length));
+	TEST_ASSERT_EQUAL(4, length);
+	TEST_ASSERT_EQUAL(sizeof(expected), nextIndex);
+	TEST_ASSERT_BYTES("WiFi", value, 4);
+
+	// The destination is too small
+	nextIndex = 0;
+	TEST_ASSERT_EQUAL(err_sizeOutOfBounds, iec61499_com_decodeSTRING(rrbID,
+			sizeof(expected), &nextIndex, value, 3, &length));
+	TEST_ASSERT_EQUAL(0, nextIndex);
+
+	// The message is truncated
+	TEST_ASSERT_EQUAL(err_indexOutOfBounds, iec61499_com_decodeSTRING(rrbID,
+			sizeof(expected) - 1, &nextIndex, value, sizeof(value), &length));
+	TEST_ASSERT_EQUAL(0, nextIndex);
+
+	nextIndex = 0;
+	iec61499_com_encodeSTRING(buffer, sizeof(buffer), &nextIndex, "", 0);
+	TEST_ASSERT_EQUAL(sizeof(empty), nextIndex);
+	TEST_ASSERT_BYTES(empty, buffer, sizeof(empty));
+}
+
+/** \brief Tests the encoding of ARRAY values */
+static void test_array(void) {
+	static const uint8_t expectedUINT[] = { 0x76, 0x00, 0x03, 0x47, 0x00, 0x01,
+			0x12, 0x34, 0xFF, 0xFF };
+	static const uint8_t expectedSINT[] = { 0x76, 0x00, 0x02, 0x42, 0xFF, 0x05 };
+	static const uint8_t expectedBOOL[] = { 0x76, 0x00, 0x03, 0x41, 0x40, 0x41 };
+	static const uint8_t expectedEmpty[] = { 0x76, 0x00, 0x00 };
+	static const uint16_t valuesUINT[] = { 1, 0x1234, 0xFFFF };
+	static const int8_t valuesSINT[] = { -1, 5 };
+	static const uint8_t valuesBOOL[] = { 1, 0, 1 };
+	uint8_t buffer[16];
+	uint16_t decodedUINT[4];
+	int8_t decodedSINT[2];
+	uint8_t decodedBOOL[3];
+	uint8_t nextIndex, rrbID, count;
+
+	nextIndex = 0;
+	iec61499_com_encodeARRAY(buffer, sizeof(buffer), &nextIndex,
+			IEC61499_COM_TAG_UINT, valuesUINT, 3);
+	TEST_ASSERT_EQUAL(sizeof(expectedUINT), nextIndex);
+	TEST_ASSERT_BYTES(expectedUINT, buffer, sizeof(expectedUINT));
+	rrbID = test_receive(expectedUINT, sizeof(expectedUINT));
+	nextIndex = 0;
+	TEST_ASSERT_EQUAL(success, iec61499_com_decodeARRAY(rrbID,
+			sizeof(expectedUINT), &nextIndex, IEC61499_COM_TAG_UINT, decodedUINT, 4,
+			&count));
+	TEST_ASSERT_EQUAL(3, count);
+	TEST_ASSERT_EQUAL(sizeof(expectedUINT), nextIndex);
+	TEST_ASSERT_BYTES(valuesUINT, decodedUINT, sizeof(valuesUINT));
+
+	// Wrong element type, too many elements and truncated messages
+	nextIndex = 0;
+	TEST_ASSERT_EQUAL(err_invalidMagicNumber, iec61499_com_decodeARRAY(rrbID,
+			sizeof(expectedUINT), &nextIndex, IEC61499_COM_TAG_INT, decodedUINT, 4,
+			&count));
+	TEST_ASSERT_EQUAL(err_sizeOutOfBounds, iec61499_com_decodeARRAY(rrbID,
+			sizeof(expectedUINT), &nextIndex, IEC61499_COM_TAG_UINT, decodedUINT, 2,
+			&count));
+	TEST_ASSERT_EQUAL(err_indexOutOfBounds, iec61499_com_decodeARRAY(rrbID,
+			sizeof(expectedUINT) - 1, &nextIndex, IEC61499_COM_TAG_UINT,
+			decodedUINT, 4, &count));
+	TEST_ASSERT_EQUAL(0, nextIndex);
+
+	nextIndex = 0;
+	iec61499_com_encodeARRAY(buffer, sizeof(buffer), &nextIndex,
+			IEC61499_COM_TAG_SINT, valuesSINT, 2);
+	TEST_ASSERT_EQUAL(sizeof(expectedSINT), nextIndex);
+	TEST_ASSERT_BYTES(expectedSINT, buffer, sizeof(expectedSINT));
+	rrbID = test_receive(expectedSINT, sizeof(expectedSINT));
+	nextIndex = 0;
+	TEST_ASSERT_EQUAL(success, iec61499_com_decodeARRAY(rrbID,
+			sizeof(expectedSINT), &nextIndex, IEC61499_COM_TAG_SINT, decodedSINT, 2,
+			&count));
+	TEST_ASSERT_EQUAL(2, count);
+	TEST_ASSERT_BYTES(valuesSINT, decodedSINT, sizeof(valuesSINT));
+
+	nextIndex = 0;
+	iec61499_com_encodeARRAY(buffer, sizeof(buffer), &nextIndex,
+			IEC61499_COM_TAG_BOOL, valuesBOOL, 3);
+	TEST_ASSERT_EQUAL(sizeof(expectedBOOL), nextIndex);
+	TEST_ASSERT_BYTES(expectedBOOL, buffer, sizeof(expectedBOOL));
+	rrbID = test_receive(expectedBOOL, sizeof(expectedBOOL));
+	nextIndex = 0;
+	TEST_ASSERT_EQUAL(success, iec61499_com_decodeARRAY(rrbID,
+			sizeof(expectedBOOL), &nextIndex, IEC61499_COM_TAG_BOOL, decodedBOOL, 3,
+			&count));
+	TEST_ASSERT_EQUAL(3, count);
+	TEST_ASSERT(decodedBOOL[0] && !decodedBOOL[1] && decodedBOOL[2]);
+
+	nextIndex = 0;
+	iec61499_com_encodeARRAY(buffer, sizeof(buffer), &nextIndex,
+			IEC61499_COM_TAG_UINT, valuesUINT, 0);
+	TEST_ASSERT_EQUAL(sizeof(expectedEmpty), nextIndex);
+	TEST_ASSERT_BYTES(expectedEmpty, buffer, sizeof(expectedEmpty));
+	rrbID = test_receive(expectedEmpty, sizeof(expectedEmpty));
+	nextIndex = 0;
+	TEST_ASSERT_EQUAL(success, iec61499_com_decodeARRAY(rrbID,
+			sizeof(expectedEmpty), &nextIndex, IEC61499_COM_TAG_UINT, decodedUINT,
+			4, &count));
+	TEST_ASSERT_EQUAL(0, count);
+	TEST_ASSERT_EQUAL(sizeof(expectedEmpty), nextIndex);
+}
+
+/** \brief The layout of the frame which is used to test the frame macros */
+#define TEST_FRAME(FIELD) \
+	FIELD(position, USINT) \
+	FIELD(temperature, INT) \
+	FIELD(update, BOOL) \
+	FIELD(mask, UDINT)
+
+IEC61499_COM_DECLARE_FRAME(test_frame, TEST_FRAME)
+static IEC61499_COM_DEFINE_DECODER(test_frame, TEST_FRAME)
+
+/** \brief Tests the template, the projection and the decoder of a frame */
+static void test_frame(void) {
+	static const uint8_t expectedTemplate[] = { 0x46, 0x00, 0x43, 0x00, 0x00,
+			0x40, 0x48, 0x00, 0x00, 0x00, 0x00 };
+	static const uint8_t expectedProjection[] = { 0x43, 0xFF, 0x85, 0x48, 0x00,
+			0x00, 0x00, 0x00 };
+	static const uint8_t message[] = { 0x46, 0x07, 0x43, 0x01, 0x02, 0x41, 0x48,
+			0x00, 0x00, 0x00, 0x05 };
+	static const uint8_t sizes[] = IEC61499_COM_FRAME_SIZES(TEST_FRAME);
+	test_frame_enc_t encoded = IEC61499_COM_FRAME_INIT(TEST_FRAME);
+	test_frame_t decoded;
+	uint8_t buffer[sizeof(encoded)];
+	uint8_t rrbID;
+
+	TEST_ASSERT_EQUAL(sizeof(expectedTemplate), sizeof(encoded));
+	TEST_ASSERT_EQUAL(6, offsetof(test_frame_enc_t, mask));
+	TEST_ASSERT_BYTES(expectedTemplate, &encoded, sizeof(expectedTemplate));
+
+	iec61499_com_updateINT(encoded.temperature, -123);
+	TEST_ASSERT_EQUAL(sizeof(expectedProjection),
+			iec61499_com_projectFrame(buffer, &encoded, sizes, 4, 0x0A));
+	TEST_ASSERT_BYTES(expectedProjection, buffer, sizeof(expectedProjection));
+
+	rrbID = test_receive(message, sizeof(message));
+	TEST_ASSERT_EQUAL(success,
+			test_frame_decode(rrbID, sizeof(message), &decoded));
+	TEST_ASSERT_EQUAL(7, decoded.position);
+	TEST_ASSERT_EQUAL(0x0102, decoded.temperature);
+	TEST_ASSERT(decoded.update != 0);
+	TEST_ASSERT_EQUAL(5, decoded.mask);
+	TEST_ASSERT_EQUAL(err_indexOutOfBounds,
+			test_frame_decode(rrbID, sizeof(message) - 1, &decoded));
+}
+
+int main(void) {
+	test_fixedSize();
+	test_bool();
+	test_errors();
+	test_string();
+	test_array();
+	test_frame();
+	return test_report("iec61499_com");
+}
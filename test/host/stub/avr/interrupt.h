@@ -0,0 +1,34 @@
+/**
+ * \file interrupt.h
+ * \brief Replaces the interrupt definitions of the AVR C library on the host
+ * \details An interrupt service routine becomes a plain function which is
+ * named after its vector. The host program calls it whenever the modelled
+ * hardware raises the interrupt.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef STUB_AVR_INTERRUPT_H_
+#define STUB_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define ISR(vector, ...) void vector(void); void vector(void)
+#define sei() do { } while (0)
+#define cli() do { } while (0)
+
+#endif /* STUB_AVR_INTERRUPT_H_ */
@@ -0,0 +1,87 @@
+/**
+ * \file io.h
+ * \brief Replaces the I/O register definitions of the AVR C library on the host
+ * \details Every register is an element of \ref stub_io at the I/O address of
+ * the ATmega8. The array is defined by the host program which models the
+ * attached hardware. Only the registers and bits of the tested modules are
+ * defined.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef STUB_AVR_IO_H_
+#define STUB_AVR_IO_H_
+
+#include <stdint.h>
+
+/** \brief The I/O registers of the simulated MCU */
+extern volatile uint8_t stub_io[0x40];
+
+/**
+ * \brief Waits until the given register bit is set
+ * \details The function is defined by the host program. It models the
+ * hardware which sets the bit.
+ * \param sfr A pointer to the register
+ * \param bit The bit number
+ */
+void stub_waitBit(volatile uint8_t *sfr, uint8_t bit);
+
+#define _BV(bit) (1 << (bit))
+#define bit_is_set(sfr, bit) ((sfr) & _BV(bit))
+#define bit_is_clear(sfr, bit) (!((sfr) & _BV(bit)))
+#define loop_until_bit_is_set(sfr, bit) stub_waitBit(&(sfr), (bit))
+
+#define SPCR stub_io[0x0D]
+#define SPSR stub_io[0x0E]
+#define SPDR stub_io[0x0F]
+#define PIND stub_io[0x10]
+#define DDRD stub_io[0x11]
+#define PORTD stub_io[0x12]
+#define PINC stub_io[0x13]
+#define DDRC stub_io[0x14]
+#define PORTC stub_io[0x15]
+#define PINB stub_io[0x16]
+#define DDRB stub_io[0x17]
+#define PORTB stub_io[0x18]
+
+#define SPR0 0
+#define SPR1 1
+#define CPHA 2
+#define CPOL 3
+#define MSTR 4
+#define DORD 5
+#define SPE 6
+#define SPIE 7
+#define SPI2X 0
+#define WCOL 6
+#define SPIF 7
+
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PINC0 0
+#define PINC1 1
+#define PINC2 2
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+
+#endif /* STUB_AVR_IO_H_ */
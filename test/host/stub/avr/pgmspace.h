@@ -0,0 +1,34 @@
+/**
+ * \file pgmspace.h
+ * \brief Replaces the program memory access of the AVR C library on the host
+ * \details The host has a single address space. Hence, constant tables are
+ * read directly.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef STUB_AVR_PGMSPACE_H_
+#define STUB_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *) (address))
+#define pgm_read_word(address) (*(const uint16_t *) (address))
+#define pgm_read_dword(address) (*(const uint32_t *) (address))
+
+#endif /* STUB_AVR_PGMSPACE_H_ */
@@ -0,0 +1,32 @@
+/**
+ * \file atomic.h
+ * \brief Replaces the atomic blocks of the AVR C library on the host
+ * \details The host programs are single threaded and call the interrupt
+ * routines explicitly. Hence, an atomic block executes its body once.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef STUB_UTIL_ATOMIC_H_
+#define STUB_UTIL_ATOMIC_H_
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) \
+	for (int stub_atomic = 1; stub_atomic; stub_atomic = 0)
+
+#endif /* STUB_UTIL_ATOMIC_H_ */
@@ -0,0 +1,95 @@
+/**
+ * \file test.h
+ * \brief Provides the assertions of the host tests
+ * \details The host tests are built by the host compiler and exercise single
+ * modules without the target hardware. The hardware specific headers are
+ * replaced by the stubs in the stub directory. Each failed assertion prints
+ * its location and is counted. A test program returns a non-zero exit code if
+ * any assertion failed.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/** \brief The number of failed assertions of the test program */
+static unsigned test_failures;
+
+/** \brief Fails if the condition doesn't hold */
+#define TEST_ASSERT(cond) do { \
+		if (!(cond)) { \
+			fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, \
+					#cond); \
+			test_failures++; \
+		} \
+	} while (0)
+
+/** \brief Fails if the integer values differ */
+#define TEST_ASSERT_EQUAL(expected, actual) do { \
+		long test_exp = (long) (expected), test_act = (long) (actual); \
+		if (test_exp != test_act) { \
+			fprintf(stderr, "%s:%d: %s: expected %ld, got %ld\n", __FILE__, \
+					__LINE__, #actual, test_exp, test_act); \
+			test_failures++; \
+		} \
+	} while (0)
+
+/** \brief Fails if the first size bytes of both buffers differ */
+#define TEST_ASSERT_BYTES(expected, actual, size) do { \
+		if (memcmp((expected), (actual), (size)) != 0) { \
+			fprintf(stderr, "%s:%d: %s differs\n", __FILE__, __LINE__, #actual); \
+			test_dump("  expected", (expected), (size)); \
+			test_dump("  actual  ", (actual), (size)); \
+			test_failures++; \
+		} \
+	} while (0)
+
+/**
+ * \brief Prints the given bytes in hexadecimal notation
+ * \param label The prefix of the line
+ * \param data The first byte to print
+ * \param size The number of bytes to print
+ */
+static inline void test_dump(const char *label, const void *data,
+		size_t size) {
+	const uint8_t *bytes = data;
+	size_t i;
+
+	fprintf(stderr, "%s:", label);
+	for (i = 0; i < size; i++) {
+		fprintf(stderr, " %02X", bytes[i]);
+	}
+	fprintf(stderr, "\n");
+}
+
+/**
+ * \brief Prints the result of the test program
+ * \param name The name of the test program
+ * \return The exit code of the test program
+ */
+static inline int test_report(const char *name) {
+	printf("%s: %s (%u failed assertions)\n", name,
+			test_failures ? "FAILED" : "passed", test_failures);
+	return test_failures ? 1 : 0;
+}
+
+#endif /* TEST_H_ */
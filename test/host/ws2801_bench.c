@@ -0,0 +1,167 @@
+/**
+ * \file ws2801_bench.c
+ * \brief Measures the update of the LED chain by the selected transfer engine
+ * \details The program is built once for each engine. The interrupt driven
+ * engine is built by default and the burst engine is built with
+ * USE_WS2801_BURST. The SPI core is modelled by \ref stub_waitBit and by
+ * calling the SPI interrupt routine once per transmitted byte. Each update
+ * changes every pixel such that the whole chain is transmitted.
+ *
+ * The benchmark reports the target figure of each engine as estimated by
+ * \ref ws2801.h. The interrupt routine of the interrupt driven engine blocks
+ * every other interrupt. Hence, \ref WS2801_ISR_CYCLES is the latency which the
+ * engine adds to the USART receive interrupt. The burst engine runs with
+ * interrupts enabled but blocks the main loop for the whole image, which is
+ * compared to \ref WS2801_BURST_BUDGET_CYCLES. Additionally, the time which the
+ * SPI core needs to shift out the chain is derived from the configured SPI
+ * clock. The host time of a complete update and of a single interrupt routine
+ * is reported for comparing revisions on the same host only. It doesn't
+ * predict the timing on the target. A checksum of the transmitted bytes shows
+ * that both engines send the same data.
+ *
+ * \author Michael Spiegel, <michael.h.spiegel@gmail.com>
+ *
+ * Copyright (C) 2016 Michael Spiegel
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "bench.h"
+
+#include "ws2801.h"
+#include "system_timer.h"
+
+#include <avr/io.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef USE_WS2801_BURST
+/** \brief The name of the measured engine */
+#define BENCH_ENGINE "burst"
+#else
+#define BENCH_ENGINE "interrupt"
+#endif
+
+/** \brief Converts CPU cycles of the target to microseconds */
+#define BENCH_CYCLES_TO_US(cycles) (1e6 * (cycles) / F_CPU)
+
+/** \brief The number of transmitted bytes per update */
+#define BENCH_UPDATE_SIZE (3 * WS2801_CHAIN_SIZE)
+
+/** \brief The number of fast timer ticks until the chain is latched */
+#define BENCH_LATCH_TICKS (SYSTEM_TIMER_MS_TO_FAST_TICKS(1) + 1)
+
+volatile uint8_t stub_io[0x40];
+
+/** \brief The number of bytes of the current update */
+extern uint8_t ws2801_transmitSize;
+
+#ifndef USE_WS2801_BURST
+void SPI_STC_vect(void);
+#endif
+
+/** \brief The checksum of the transmitted bytes */
+static uint16_t bench_checksum;
+/** \brief The number of transmitted bytes */
+static unsigned long bench_bytes;
+/** \brief The accumulated host time of the interrupt routine */
+static double bench_isrTime;
+
+/**
+ * \brief Records the byte which is shifted out
+ * \param value The transmitted byte
+ */
+static void bench_record(uint8_t value) {
+	bench_checksum = (uint16_t) ((bench_checksum << 1) | (bench_checksum >> 15))
+			^ value;
+	bench_bytes++;
+}
+
+void stub_waitBit(volatile uint8_t *sfr, uint8_t bit) {
+	// The burst engine waits for the byte in the data register
+	bench_record(SPDR);
+}
+
+/**
+ * \brief Changes every pixel and transmits the whole chain
+ * \param color The color value of the update
+ */
+static void bench_update(uint8_t color) {
+	uint8_t i;
+#ifndef USE_WS2801_BURST
+	uint8_t size;
+	double start;
+#endif
+
+	(void) ws2801_fillValues(0, WS2801_CHAIN_SIZE, color, color + 1, color + 2);
+	(void) ws2801_update();
+
+#ifndef USE_WS2801_BURST
+	// Each completed byte raises the SPI interrupt
+	size = ws2801_transmitSize;
+	start = bench_now();
+	for (i = 0; i < size; i++) {
+		bench_record(SPDR);
+		SPI_STC_vect();
+	}
+	bench_isrTime += bench_now() - start;
+#endif
+
+	for (i = 0; i < BENCH_LATCH_TICKS; i++) {
+		ws2801_timedFastTick();
+	}
+}
+
+int main(void) {
+	uint8_t color;
+	double ns;
+
+	ws2801_init();
+	bench_update(0);
+
+	// The checksum covers a fixed sequence of updates
+	bench_checksum = 0;
+	bench_bytes = 0;
+	for (color = 1; color < 65; color++) {
+		bench_update(color);
+	}
+	printf("%s engine: %lu bytes, checksum %04X\n", BENCH_ENGINE, bench_bytes,
+			bench_checksum);
+
+	bench_bytes = 0;
+	bench_isrTime = 0;
+	BENCH_MEASURE(ns, bench_update((uint8_t) (2 * bench_i)));
+	printf("%s engine: %.1f ns per update of %u bytes (host only)\n",
+			BENCH_ENGINE, ns, BENCH_UPDATE_SIZE);
+#ifdef USE_WS2801_BURST
+	printf("%s engine: %lu cycles (%.1f us) main loop blocking per update, "
+			"budget %lu cycles (%.1f us) (target)\n", BENCH_ENGINE,
+			3UL * WS2801_CHAIN_SIZE * WS2801_BURST_BYTE_CYCLES,
+			BENCH_CYCLES_TO_US(3UL * WS2801_CHAIN_SIZE * WS2801_BURST_BYTE_CYCLES),
+			WS2801_BURST_BUDGET_CYCLES,
+			BENCH_CYCLES_TO_US(WS2801_BURST_BUDGET_CYCLES));
+#else
+	printf("%s engine: %.1f ns per interrupt routine (host only)\n",
+			BENCH_ENGINE, bench_isrTime * 1e9 / bench_bytes);
+	printf("%s engine: %u cycles (%.1f us) added USART latency per interrupt "
+			"routine (target)\n", BENCH_ENGINE, WS2801_ISR_CYCLES,
+			BENCH_CYCLES_TO_US(WS2801_ISR_CYCLES));
+#endif
+	printf("%s engine: %lu cycles (%.1f us) to shift out %u bytes at fosc/%d "
+			"(target)\n", BENCH_ENGINE,
+			8UL * WS2801_SPI_DIVIDER * BENCH_UPDATE_SIZE,
+			BENCH_CYCLES_TO_US(8UL * WS2801_SPI_DIVIDER * BENCH_UPDATE_SIZE),
+			BENCH_UPDATE_SIZE, WS2801_SPI_DIVIDER);
+	return 0;
+}